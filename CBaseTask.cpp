@@ -7,14 +7,65 @@
 */
 
 #include "CBaseTask.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include "sdkconfig.h"
 #include "CTrace.h"
+#include "esp_cpu.h"
+#include "CMsgRecorder.h"
+#ifdef CONFIG_TASK_WATCHDOG
+#include "esp_timer.h"
+
+void IRAM_ATTR CBaseTask::markSent()
+{
+	int64_t tm = esp_timer_get_time();
+	taskENTER_CRITICAL_SAFE(&mWatchdogMux);
+	// Если задача уже выбрала сообщение и опустошила очередь, то метка не ставится.
+	if ((mPendingSince == 0) && (uxQueueMessagesWaitingFromISR(mTaskQueue) != 0))
+		mPendingSince = tm;
+	taskEXIT_CRITICAL_SAFE(&mWatchdogMux);
+}
+
+void CBaseTask::markReceived(bool received)
+{
+	int64_t tm = esp_timer_get_time();
+	// Очередь проверяется под тем же мьютексом, что и в markSent(): сообщение, поставленное после проверки,
+	// получит метку в markSent(), поставленное до проверки - не даст сбросить метку.
+	taskENTER_CRITICAL(&mWatchdogMux);
+	if (uxQueueMessagesWaiting(mTaskQueue) == 0)
+	{
+		mPendingSince = 0;
+		mLastDrain = tm;
+	}
+	else if (received)
+	{
+		mPendingSince = tm;
+	}
+	taskEXIT_CRITICAL(&mWatchdogMux);
+}
+#endif
 
 void CBaseTask::vTask(void *pvParameters)
 {
-	((CBaseTask *)pvParameters)->run();
+	CBaseTask *task = (CBaseTask *)pvParameters;
+	for (;;)
+	{
+		task->run();
+		if (task->mMigrateTo < 0)
+			break;
+
+		BaseType_t coreID = task->mMigrateTo;
+		BaseType_t oldCoreID = task->mCoreID;
+		task->mMigrateTo = -1;
+		// Новая задача может начать работу и попасть в замер до возврата из xTaskCreatePinnedToCore.
+		task->mCoreID = coreID;
+		if (xTaskCreatePinnedToCore(vTask, pcTaskGetName(nullptr), task->mStack, task, task->mPriority, &task->mTaskHandle, coreID) == pdPASS)
+			vTaskDelete(nullptr);
+		task->mCoreID = oldCoreID;
+		task->mTaskHandle = xTaskGetCurrentTaskHandle();
+		ESP_LOGW(pcTaskGetName(nullptr), "migrate to core %d failed", coreID);
+	}
 	vQueueDelete(((CBaseTask *)pvParameters)->mTaskQueue);
 	((CBaseTask *)pvParameters)->mTaskQueue = nullptr;
 	ESP_LOGI(pcTaskGetName(((CBaseTask *)pvParameters)->mTaskHandle), "exit");
@@ -45,16 +96,66 @@ void CBaseTask::init(const char *name, unsigned short usStack, UBaseType_t uxPri
 	assert(usStack >= configMINIMAL_STACK_SIZE);
 	assert(std::strlen(name) < configMAX_TASK_NAME_LEN);
 
+	mStack = usStack;
+	mPriority = uxPriority;
+	mCoreID = coreID;
+#ifdef CONFIG_TASK_WATCHDOG
+	mLastDrain = esp_timer_get_time();
+#endif
 	mTaskQueue = xQueueCreate(queueLength, sizeof(STaskMessage));
 	xTaskCreatePinnedToCore(vTask, name, usStack, this, uxPriority, &mTaskHandle, coreID);
 }
 
+void CBaseTask::init(const char *name, unsigned short usStack, UBaseType_t uxPriority, UBaseType_t queueLength,
+					 StackType_t *stack, StaticTask_t *tcb, uint8_t *queueBuffer, StaticQueue_t *queue, BaseType_t coreID)
+{
+	assert(uxPriority < configMAX_PRIORITIES);
+	assert(usStack >= configMINIMAL_STACK_SIZE);
+	assert(std::strlen(name) < configMAX_TASK_NAME_LEN);
+	assert((stack != nullptr) && (tcb != nullptr) && (queueBuffer != nullptr) && (queue != nullptr));
+
+	mStack = usStack;
+	mPriority = uxPriority;
+	mCoreID = coreID;
+	mStatic = true;
+#ifdef CONFIG_TASK_WATCHDOG
+	mLastDrain = esp_timer_get_time();
+#endif
+	mTaskQueue = xQueueCreateStatic(queueLength, sizeof(STaskMessage), queueBuffer, queue);
+	mTaskHandle = xTaskCreateStaticPinnedToCore(vTask, name, usStack, this, uxPriority, stack, tcb, coreID);
+}
+
+bool CBaseTask::migrate(BaseType_t coreID)
+{
+	assert((coreID >= 0) && (coreID < portNUM_PROCESSORS));
+
+	if (!mMigratable || (mTaskHandle == nullptr) || (coreID == mCoreID) || isMigrating())
+		return false;
+#if (configUSE_CORE_AFFINITY == 1)
+	vTaskCoreAffinitySet(mTaskHandle, (1 << coreID));
+	mCoreID = coreID;
+#else
+	if (mStatic)
+		return false; // пересоздание задачи требует динамического стека
+	mMigrateTo = coreID;
+#if (INCLUDE_xTaskAbortDelay == 1)
+	xTaskAbortDelay(mTaskHandle);
+#endif
+#endif
+	return true;
+}
+
 bool CBaseTask::sendMessage(STaskMessage *msg, TickType_t xTicksToWait, bool free_mem)
 {
 	assert(msg != nullptr);
 
 	if (xQueueSend(mTaskQueue, msg, xTicksToWait) == pdPASS)
 	{
+		if (mSpinMax != 0)
+			mReady.store(1, std::memory_order_release);
+#ifdef CONFIG_TASK_WATCHDOG
+		markSent();
+#endif
 		if (mNotify != 0)
 		{
 			return (xTaskNotify(mTaskHandle, mNotify, eSetBits) == pdPASS);
@@ -65,7 +166,7 @@ bool CBaseTask::sendMessage(STaskMessage *msg, TickType_t xTicksToWait, bool fre
 	else
 	{
 		if (free_mem)
-			vPortFree(msg->msgBody);
+			freeMsg(msg->msgBody);
 		TRACE_WARNING(pcTaskGetName(mTaskHandle), msg->msgID);
 		return false;
 	}
@@ -77,6 +178,11 @@ bool CBaseTask::sendMessageFront(STaskMessage *msg, TickType_t xTicksToWait, boo
 
 	if (xQueueSendToFront(mTaskQueue, msg, xTicksToWait) == pdPASS)
 	{
+		if (mSpinMax != 0)
+			mReady.store(1, std::memory_order_release);
+#ifdef CONFIG_TASK_WATCHDOG
+		markSent();
+#endif
 		if (mNotify != 0)
 		{
 			return (xTaskNotify(mTaskHandle, mNotify, eSetBits) == pdPASS);
@@ -87,7 +193,7 @@ bool CBaseTask::sendMessageFront(STaskMessage *msg, TickType_t xTicksToWait, boo
 	else
 	{
 		if (free_mem)
-			vPortFree(msg->msgBody);
+			freeMsg(msg->msgBody);
 		TRACE_WARNING(pcTaskGetName(mTaskHandle), msg->msgID);
 		return false;
 	}
@@ -99,6 +205,11 @@ bool IRAM_ATTR CBaseTask::sendMessageFromISR(STaskMessage *msg, BaseType_t *pxHi
 
 	if (xQueueSendFromISR(mTaskQueue, msg, pxHigherPriorityTaskWoken) == pdPASS)
 	{
+		if (mSpinMax != 0)
+			mReady.store(1, std::memory_order_release);
+#ifdef CONFIG_TASK_WATCHDOG
+		markSent();
+#endif
 		if (mNotify != 0)
 		{
 			return (xTaskNotifyFromISR(mTaskHandle, mNotify, eSetBits, pxHigherPriorityTaskWoken) == pdPASS);
@@ -114,7 +225,135 @@ bool CBaseTask::getMessage(STaskMessage *msg, TickType_t xTicksToWait)
 {
 	assert(msg != nullptr);
 
-	return (xQueueReceive(mTaskQueue, msg, xTicksToWait) == pdTRUE);
+	if (isMigrating())
+		return false;
+#ifdef CONFIG_TASK_RECORDER
+	CMsgRecorder *recorder = mRecorder;
+	if ((recorder != nullptr) && (xTicksToWait != 0))
+		recorder->idle();
+#endif
+	bool res;
+	if ((mSpinMax != 0) && (xTicksToWait != 0))
+		res = spinMessage(msg, xTicksToWait);
+	else
+		res = (xQueueReceive(mTaskQueue, msg, xTicksToWait) == pdTRUE);
+#ifdef CONFIG_TASK_WATCHDOG
+	markReceived(res);
+#endif
+#ifdef CONFIG_TASK_RECORDER
+	recorder = mRecorder;
+	if (res && (recorder != nullptr))
+		recorder->received(msg);
+#endif
+	return res;
+}
+
+bool CBaseTask::spinMessage(STaskMessage *msg, TickType_t xTicksToWait)
+{
+	// Флаг сбрасывается до проверки очереди: сообщение, отправленное после проверки, снова выставит его.
+	mReady.store(0, std::memory_order_relaxed);
+	bool res = (xQueueReceive(mTaskQueue, msg, 0) == pdTRUE);
+	if (res)
+	{
+		mSpinStats.immediate++;
+	}
+	else
+	{
+		uint32_t budget = mSpinMax;
+		if (mSpinAdaptive)
+			budget = (mArrivalAvg < mSpinMax) ? std::min(mArrivalAvg + (mArrivalAvg >> 1), mSpinMax) : 0;
+		mSpinStats.budget = budget;
+
+		uint32_t start = esp_cpu_get_cycle_count();
+		while ((esp_cpu_get_cycle_count() - start) < budget)
+		{
+			if (mReady.load(std::memory_order_acquire) != 0)
+			{
+				res = (xQueueReceive(mTaskQueue, msg, 0) == pdTRUE);
+				break;
+			}
+		}
+		if (res)
+		{
+			mSpinStats.spinHits++;
+		}
+		else
+		{
+			mSpinStats.blocks++;
+			res = (xQueueReceive(mTaskQueue, msg, xTicksToWait) == pdTRUE);
+		}
+	}
+
+	if (res)
+	{
+		uint32_t tm = esp_cpu_get_cycle_count();
+		uint32_t interval = tm - mLastArrival;
+		mLastArrival = tm;
+		mArrivalAvg = mArrivalAvg - (mArrivalAvg >> 3) + (interval >> 3);
+	}
+	return res;
+}
+
+void CBaseTask::setSpinReceive(uint32_t cycles, bool adaptive)
+{
+	mSpinAdaptive = adaptive;
+	mArrivalAvg = cycles;
+	mLastArrival = esp_cpu_get_cycle_count();
+	mSpinStats = {};
+	// На одноядерном CPU отправитель не может выполняться во время активного ожидания.
+	mSpinMax = (portNUM_PROCESSORS > 1) ? cycles : 0;
+}
+
+void CBaseTask::printSpinStats()
+{
+	uint32_t waits = mSpinStats.spinHits + mSpinStats.blocks;
+	ESP_LOGI(pcTaskGetName(mTaskHandle), "spin: immediate %ld, hits %ld, blocks %ld, hit ratio %ld%%, budget %ld",
+			 (long)mSpinStats.immediate, (long)mSpinStats.spinHits, (long)mSpinStats.blocks,
+			 (long)((waits == 0) ? 0 : (mSpinStats.spinHits * 100ull) / waits), (long)mSpinStats.budget);
+}
+
+STaskEvents CBaseTask::waitAny(STaskMessage *buf, uint16_t size, TickType_t xTicksToWait)
+{
+	assert(buf != nullptr);
+	assert(size > 0);
+
+#ifdef CONFIG_TASK_RECORDER
+	CMsgRecorder *recorder = mRecorder;
+	if (recorder != nullptr)
+		recorder->idle();
+#endif
+
+	STaskEvents ev = {0, 0};
+	TickType_t start = xTaskGetTickCount();
+	for (;;)
+	{
+		// Сначала сбрасываем биты, потом выбираем очередь: сообщение, пришедшее между ними, снова выставит бит.
+		uint32_t bits = 0;
+		xTaskNotifyWait(0, 0xffffffff, &bits, 0);
+		ev.bits |= bits & ~mNotify;
+		while ((ev.count < size) && getMessage(&buf[ev.count], 0))
+			ev.count++;
+		if ((ev.count > 0) || (ev.bits != 0) || isMigrating())
+			break;
+
+		TickType_t wait = portMAX_DELAY;
+		if (xTicksToWait != portMAX_DELAY)
+		{
+			TickType_t elapsed = xTaskGetTickCount() - start;
+			if (elapsed >= xTicksToWait)
+				break;
+			wait = xTicksToWait - elapsed;
+		}
+		if (mNotify != 0)
+		{
+			// Полученные биты сбрасываются здесь же: без ожидания FreeRTOS биты не сбрасывает.
+			xTaskNotifyWait(0, 0xffffffff, &bits, wait);
+			ev.bits |= bits & ~mNotify;
+		}
+		else
+			xQueuePeek(mTaskQueue, &buf[0], wait);
+	}
+	return ev;
 }
 
 uint8_t *CBaseTask::allocNewMsg(STaskMessage *msg, uint16_t cmd, uint16_t size)
@@ -127,3 +366,27 @@ uint8_t *CBaseTask::allocNewMsg(STaskMessage *msg, uint16_t cmd, uint16_t size)
 	msg->msgBody = pvPortMalloc(msg->shortParam);
 	return (uint8_t *)msg->msgBody;
 }
+
+uint8_t *CBaseTask::allocNewMsg(STaskMessage *msg, uint16_t cmd, uint16_t size, IMsgAllocator *allocator)
+{
+	assert(msg != nullptr);
+	assert(size > 0);
+
+	if (allocator == nullptr)
+		return allocNewMsg(msg, cmd, size);
+	msg->msgID = cmd;
+	msg->shortParam = size;
+	msg->msgBody = allocator->allocate(msg->shortParam);
+	return (uint8_t *)msg->msgBody;
+}
+
+void CBaseTask::freeMsg(void *body)
+{
+	if (body == nullptr)
+		return;
+	IMsgAllocator *allocator = IMsgAllocator::find(body);
+	if (allocator != nullptr)
+		allocator->release(body);
+	else
+		vPortFree(body);
+}
@@ -0,0 +1,107 @@
+/*!
+	\file
+	\brief Кольцо слотов общей памяти для передачи блоков данных между ядрами.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CBulkRing.h"
+#include "CTrace.h"
+
+CBulkRing::CBulkRing(uint32_t slotSize, uint16_t slots, uint32_t caps) : mSlotSize((slotSize + BULKRING_ALIGN - 1) & ~(uint32_t)(BULKRING_ALIGN - 1)), mSlots(slots)
+{
+	assert(slotSize > 0);
+	assert(slots > 0);
+
+	mBuffer = (uint8_t *)heap_caps_aligned_alloc(BULKRING_ALIGN, mSlotSize * mSlots, caps);
+	mSizes = new uint32_t[mSlots];
+	mFree = xSemaphoreCreateBinary();
+	if (mBuffer == nullptr)
+	{
+		mSlots = 0;
+		TRACE_ERROR("CBulkRing:no memory", slotSize * slots);
+	}
+}
+
+CBulkRing::~CBulkRing()
+{
+	if (mBuffer != nullptr)
+		heap_caps_free(mBuffer);
+	delete[] mSizes;
+	vSemaphoreDelete(mFree);
+}
+
+void CBulkRing::setConsumer(CBaseTask *task, uint16_t msgID, bool edge)
+{
+	mMsgID = msgID;
+	mEdge = edge;
+	mTask = task;
+}
+
+uint8_t *CBulkRing::acquire(TickType_t xTicksToWait)
+{
+	if (mSlots == 0)
+		return nullptr;
+
+	uint32_t head = mHead.load(std::memory_order_relaxed);
+	while (count(head, mTail.load(std::memory_order_acquire)) >= mSlots)
+	{
+		// Семафор может остаться от прошлого освобождения, поэтому условие проверяется повторно.
+		if ((xTicksToWait == 0) || (xSemaphoreTake(mFree, xTicksToWait) != pdTRUE))
+		{
+			mFull++;
+			return nullptr;
+		}
+	}
+	return slot(position(head));
+}
+
+uint16_t CBulkRing::commit(uint32_t size)
+{
+	uint32_t head = mHead.load(std::memory_order_relaxed);
+	uint16_t index = position(head);
+	mSizes[index] = size;
+	head = next(head);
+	// seq_cst: запись mHead и чтение mTail не переставляются (пара с release()).
+	mHead.store(head, std::memory_order_seq_cst);
+	uint32_t used = count(head, mTail.load(std::memory_order_seq_cst));
+	if (used > mPeak)
+		mPeak = used;
+
+	if ((mTask != nullptr) && (!mEdge || (used == 1)))
+	{
+		STaskMessage msg;
+		msg.msgID = mMsgID;
+		msg.shortParam = index;
+		msg.paramID = size;
+		if (!mTask->sendMessage(&msg, 0, false))
+			mLost++;
+	}
+	return index;
+}
+
+uint8_t *CBulkRing::front(uint32_t *size)
+{
+	uint32_t tail = mTail.load(std::memory_order_relaxed);
+	// seq_cst: после release() чтение mHead не переставляется с записью mTail (пара с commit()).
+	if (mHead.load(std::memory_order_seq_cst) == tail)
+		return nullptr;
+
+	uint16_t index = position(tail);
+	if (size != nullptr)
+		*size = mSizes[index];
+	return slot(index);
+}
+
+void CBulkRing::release()
+{
+	uint32_t tail = mTail.load(std::memory_order_relaxed);
+	uint32_t head = mHead.load(std::memory_order_acquire);
+	if (head == tail)
+		return;
+
+	mTail.store(next(tail), std::memory_order_seq_cst);
+	if (count(head, tail) >= mSlots)
+		xSemaphoreGive(mFree);
+}
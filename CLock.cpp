@@ -2,24 +2,131 @@
 	\file
 	\brief Базовый класс для захвата ресурса задач FreeRTOS.
     \authors Близнец Р.А. (r.bliznets@gmail.com)
-	\version 1.1.0.0
+	\version 1.2.0.0
 	\date 28.04.2020
 */
 
 #include "CLock.h"
 
-CLock::CLock()
+#ifdef CONFIG_LOCK_STATISTICS
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "Lock";
+
+#define LOCK_STATS_TOP 16 ///< Максимальное количество ресурсов в printStats().
+
+CLock *CLock::mFirst = nullptr;
+portMUX_TYPE CLock::mListMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+CLock::CLock(const char *name)
 {
+#ifdef CONFIG_LOCK_STATISTICS
+	mStats.name = name;
+	taskENTER_CRITICAL(&mListMux);
+	mNext = mFirst;
+	mFirst = this;
+	taskEXIT_CRITICAL(&mListMux);
+#endif
+}
+
+CLock::~CLock()
+{
+#ifdef CONFIG_LOCK_STATISTICS
+	taskENTER_CRITICAL(&mListMux);
+	for (CLock **x = &mFirst; *x != nullptr; x = &(*x)->mNext)
+	{
+		if (*x == this)
+		{
+			*x = mNext;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&mListMux);
+#endif
 }
 
 void CLock::lock()
 {
-	if (mMutex != nullptr)
-		xSemaphoreTake(mMutex, portMAX_DELAY);
+	tryLock(portMAX_DELAY);
+}
+
+bool CLock::tryLock(TickType_t xTicksToWait)
+{
+	if (mMutex == nullptr)
+		return true;
+#ifdef CONFIG_LOCK_STATISTICS
+	if (xSemaphoreTake(mMutex, 0) == pdTRUE)
+	{
+		mLockTime = esp_timer_get_time();
+	}
+	else
+	{
+		int64_t tm = esp_timer_get_time();
+		if ((xTicksToWait == 0) || (xSemaphoreTake(mMutex, xTicksToWait) != pdTRUE))
+			return false;
+		mLockTime = esp_timer_get_time();
+		int64_t wait = mLockTime - tm;
+		mStats.contended++;
+		mStats.totalWait += wait;
+		if (wait > mStats.maxWait)
+			mStats.maxWait = wait;
+	}
+	mStats.count++;
+	return true;
+#else
+	return (xSemaphoreTake(mMutex, xTicksToWait) == pdTRUE);
+#endif
 }
 
 void CLock::unlock()
 {
 	if (mMutex != nullptr)
+	{
+#ifdef CONFIG_LOCK_STATISTICS
+		int64_t hold = esp_timer_get_time() - mLockTime;
+		if (hold > mStats.maxHold)
+			mStats.maxHold = hold;
+#endif
 		xSemaphoreGive(mMutex);
+	}
+}
+
+#ifdef CONFIG_LOCK_STATISTICS
+void CLock::getStats(SLockStats *stats)
+{
+	// Без захвата ресурса, чтобы не искажать статистику.
+	*stats = mStats;
+}
+
+void CLock::printStats(uint8_t top)
+{
+	SLockStats stats[LOCK_STATS_TOP];
+	uint8_t n = 0;
+	if (top > LOCK_STATS_TOP)
+		top = LOCK_STATS_TOP;
+	taskENTER_CRITICAL(&mListMux);
+	for (CLock *x = mFirst; x != nullptr; x = x->mNext)
+	{
+		// Вставка в отсортированный по убыванию времени ожидания массив.
+		uint8_t i = (n < top) ? n++ : top;
+		while ((i > 0) && (stats[i - 1].totalWait < x->mStats.totalWait))
+		{
+			if (i < top)
+				stats[i] = stats[i - 1];
+			i--;
+		}
+		if (i < top)
+			stats[i] = x->mStats;
+	}
+	taskEXIT_CRITICAL(&mListMux);
+
+	for (uint8_t i = 0; i < n; i++)
+	{
+		ESP_LOGI(TAG, "%s: count %ld, contended %ld, wait %lldus (max %lldus), max hold %lldus",
+				 (stats[i].name == nullptr) ? "?" : stats[i].name, (long)stats[i].count, (long)stats[i].contended,
+				 (long long)stats[i].totalWait, (long long)stats[i].maxWait, (long long)stats[i].maxHold);
+	}
 }
+#endif
@@ -0,0 +1,74 @@
+/*!
+	\file
+	\brief Распределитель памяти сообщений по циклам (эпохам).
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CMsgArena.h"
+#include "CTrace.h"
+
+#define ARENA_BANK_BIT (31)							///< Бит номера банка в mState.
+#define ARENA_OFFSET_MASK ((1u << ARENA_BANK_BIT) - 1) ///< Маска смещения в mState.
+
+CMsgArena::CMsgArena(uint32_t size, uint8_t consumers, uint32_t caps) : IMsgAllocator(), mSize(size), mConsumers(consumers)
+{
+	assert(size > 0);
+	assert(size < ARENA_OFFSET_MASK);
+	assert(consumers > 0);
+
+	mAcks[0] = 0;
+	mAcks[1] = consumers; // второй банк свободен
+	mBuffer = (uint8_t *)heap_caps_malloc(2 * mSize, caps);
+	if (mBuffer == nullptr)
+	{
+		mSize = 0;
+		TRACE_ERROR("CMsgArena:no memory", size);
+	}
+}
+
+CMsgArena::~CMsgArena()
+{
+	if (mBuffer != nullptr)
+		heap_caps_free(mBuffer);
+}
+
+void *CMsgArena::allocate(size_t size)
+{
+	size = (size + 3) & ~(size_t)3;
+	uint32_t st = mState.load(std::memory_order_relaxed);
+	uint32_t offset;
+	do
+	{
+		offset = st & ARENA_OFFSET_MASK;
+		if ((offset + size) > mSize)
+		{
+			mFailed.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+	} while (!mState.compare_exchange_weak(st, st + size, std::memory_order_acq_rel, std::memory_order_relaxed));
+	mAllocated.fetch_add(1, std::memory_order_relaxed);
+	return &mBuffer[(st >> ARENA_BANK_BIT) * mSize + offset];
+}
+
+bool CMsgArena::nextEpoch()
+{
+	uint32_t epoch = mEpoch.load(std::memory_order_relaxed);
+	uint32_t next = (epoch + 1) & 1;
+	if (mAcks[next].load(std::memory_order_acquire) < mConsumers)
+		return false;
+
+	uint32_t used = getUsed();
+	if (used > mPeak)
+		mPeak = used;
+	mAcks[next].store(0, std::memory_order_relaxed);
+	mState.store(next << ARENA_BANK_BIT, std::memory_order_release);
+	mEpoch.store(epoch + 1, std::memory_order_release);
+	return true;
+}
+
+void CMsgArena::ack(uint32_t epoch)
+{
+	mAcks[epoch & 1].fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,222 @@
+/*!
+	\file
+	\brief Запись и воспроизведение потока сообщений задачи CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CMsgRecorder.h"
+
+#ifdef CONFIG_TASK_RECORDER
+
+#include "CTrace.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "MsgRecorder";
+
+CMsgRecorder::CMsgRecorder() : CLock(TAG)
+{
+	CLock::init(xSemaphoreCreateMutex());
+	mDone = xSemaphoreCreateBinary();
+}
+
+CMsgRecorder::~CMsgRecorder()
+{
+	stopRecord();
+	vSemaphoreDelete(mDone);
+	vSemaphoreDelete(mMutex);
+}
+
+bool CMsgRecorder::startRecord(const char *fileName, msg_body_cb_t cb)
+{
+	stopRecord();
+
+	FILE *f = fopen(fileName, "wb");
+	if (f == nullptr)
+	{
+		TRACE_ERROR("CMsgRecorder:open failed", 0);
+		return false;
+	}
+	SMsgRecordHeader hdr = {MSGRECORDER_MAGIC, MSGRECORDER_VERSION, 0, 0};
+	fwrite(&hdr, sizeof(hdr), 1, f);
+
+	lock();
+	mBodyCb = cb;
+	mCount = 0;
+	mLastTime = 0;
+	mFile = f;
+	unlock();
+	return true;
+}
+
+uint32_t CMsgRecorder::stopRecord()
+{
+	lock();
+	FILE *f = mFile;
+	mFile = nullptr;
+	unlock();
+	if (f == nullptr)
+		return 0;
+
+	// Количество сообщений известно только в конце записи.
+	SMsgRecordHeader hdr = {MSGRECORDER_MAGIC, MSGRECORDER_VERSION, 0, mCount};
+	fseek(f, 0, SEEK_SET);
+	fwrite(&hdr, sizeof(hdr), 1, f);
+	fclose(f);
+	return mCount;
+}
+
+void CMsgRecorder::received(const STaskMessage *msg)
+{
+	uint32_t total = mTotal.load(std::memory_order_acquire);
+	if (total != 0)
+	{
+		int64_t tm = esp_timer_get_time();
+		if (mBusySince == 0)
+			mBusySince = tm;
+		// Окончание отмечается при приеме последнего сообщения: задача может больше не ждать сообщений
+		// (выборка очереди без ожидания, выход из run()), и idle() не будет вызван.
+		if ((mProcessed.fetch_add(1, std::memory_order_relaxed) + 1) >= total)
+		{
+			mStats.busy += tm - mBusySince;
+			mBusySince = 0;
+			mEnd = tm;
+			mTotal.store(0, std::memory_order_release);
+			xSemaphoreGive(mDone);
+		}
+		return;
+	}
+
+	lock();
+	if (mFile != nullptr)
+	{
+		int64_t tm = esp_timer_get_time();
+		SMsgRecord rec;
+		rec.delta = (mCount == 0) ? 0 : (uint32_t)(tm - mLastTime);
+		rec.msgID = msg->msgID;
+		rec.shortParam = msg->shortParam;
+		rec.paramID = msg->paramID;
+		rec.bodySize = (mBodyCb == nullptr) ? 0 : mBodyCb(msg);
+		rec.reserved = 0;
+		fwrite(&rec, sizeof(rec), 1, mFile);
+		if (rec.bodySize != 0)
+			fwrite(msg->msgBody, 1, rec.bodySize, mFile);
+		mLastTime = tm;
+		mCount++;
+	}
+	unlock();
+}
+
+void CMsgRecorder::idle()
+{
+	uint32_t total = mTotal.load(std::memory_order_acquire);
+	if ((total == 0) || (mBusySince == 0))
+		return;
+
+	mStats.busy += esp_timer_get_time() - mBusySince;
+	mBusySince = 0;
+}
+
+bool CMsgRecorder::replay(const char *fileName, CBaseTask *task, bool realtime, TickType_t xTicksToWait)
+{
+	assert(task != nullptr);
+	assert(mFile == nullptr);
+
+	FILE *f = fopen(fileName, "rb");
+	if (f == nullptr)
+	{
+		TRACE_ERROR("CMsgRecorder:open failed", 0);
+		return false;
+	}
+	SMsgRecordHeader hdr;
+	if ((fread(&hdr, sizeof(hdr), 1, f) != 1) || (hdr.magic != MSGRECORDER_MAGIC) || (hdr.version != MSGRECORDER_VERSION))
+	{
+		fclose(f);
+		TRACE_ERROR("CMsgRecorder:wrong file", 0);
+		return false;
+	}
+
+	mStats = {};
+	if (hdr.count == 0)
+	{
+		fclose(f);
+		return true;
+	}
+	mProcessed.store(0, std::memory_order_relaxed);
+	mBusySince = 0;
+	xSemaphoreTake(mDone, 0);
+	mTotal.store(hdr.count, std::memory_order_release);
+	task->setRecorder(this);
+
+	bool res = true;
+	int64_t start = esp_timer_get_time();
+	int64_t target = 0;
+	SMsgRecord rec;
+	STaskMessage msg;
+	for (uint32_t i = 0; i < hdr.count; i++)
+	{
+		if (fread(&rec, sizeof(rec), 1, f) != 1)
+		{
+			res = false;
+			break;
+		}
+		if (realtime)
+		{
+			target += rec.delta;
+			int64_t wait = (target - (esp_timer_get_time() - start)) / (portTICK_PERIOD_MS * 1000);
+			if (wait > 0)
+				vTaskDelay(wait);
+		}
+		if (rec.bodySize != 0)
+		{
+			uint8_t *body = CBaseTask::allocNewMsg(&msg, rec.msgID, rec.bodySize);
+			if ((body == nullptr) || (fread(body, 1, rec.bodySize, f) != rec.bodySize))
+			{
+				CBaseTask::freeMsg(body);
+				res = false;
+				break;
+			}
+			msg.shortParam = rec.shortParam;
+			mStats.bytes += rec.bodySize;
+		}
+		else
+		{
+			msg.msgID = rec.msgID;
+			msg.shortParam = rec.shortParam;
+			msg.paramID = rec.paramID;
+		}
+		if (!task->sendMessage(&msg, portMAX_DELAY, true))
+		{
+			res = false;
+			break;
+		}
+	}
+	fclose(f);
+
+	if (res)
+		res = (xSemaphoreTake(mDone, xTicksToWait) == pdTRUE);
+	task->setRecorder(nullptr);
+	if (!res)
+	{
+		mTotal.store(0, std::memory_order_release);
+		TRACE_ERROR("CMsgRecorder:replay failed", mProcessed.load(std::memory_order_relaxed));
+		return false;
+	}
+
+	mStats.messages = mProcessed.load(std::memory_order_relaxed);
+	mStats.time = mEnd - start;
+	return true;
+}
+
+void CMsgRecorder::printStats()
+{
+	// Обработка последнего сообщения в busy не входит: воспроизведение завершается при его приеме.
+	uint32_t timed = (mStats.messages > 1) ? (mStats.messages - 1) : 0;
+	ESP_LOGI(TAG, "messages %ld, bytes %ld, time %lldus, %lld msg/s, busy %lldns/msg", (long)mStats.messages, (long)mStats.bytes,
+			 (long long)mStats.time, (long long)((mStats.time == 0) ? 0 : (mStats.messages * 1000000ll) / mStats.time),
+			 (long long)((timed == 0) ? 0 : (mStats.busy * 1000) / timed));
+}
+
+#endif // CONFIG_TASK_RECORDER
@@ -0,0 +1,163 @@
+/*!
+	\file
+	\brief Синхронизация фаз параллельной обработки в нескольких задачах.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CPhaser.h"
+#include <cstring>
+#include "esp_timer.h"
+#include "CTrace.h"
+
+CPhaser::CPhaser(uint32_t parties, uint32_t spin) : mState(state(0, parties, parties)), mSpin((portNUM_PROCESSORS > 1) ? spin : 0)
+{
+	assert(parties <= PHASER_MAX_PARTIES);
+
+	resetStats();
+	mEvents = xEventGroupCreate();
+	if (mEvents == nullptr)
+		TRACE_ERROR("CPhaser:xEventGroupCreate failed", -1);
+	mSignalMutex = xSemaphoreCreateMutex();
+	if (mSignalMutex == nullptr)
+		TRACE_ERROR("CPhaser:xSemaphoreCreateMutex failed", -1);
+}
+
+CPhaser::~CPhaser()
+{
+	if (mSignalMutex != nullptr)
+		vSemaphoreDelete(mSignalMutex);
+	if (mEvents != nullptr)
+		vEventGroupDelete(mEvents);
+}
+
+uint32_t CPhaser::registerParty()
+{
+	uint64_t s = mState.load(std::memory_order_acquire);
+	for (;;)
+	{
+		uint32_t parties = (uint32_t)((s >> PARTIES_SHIFT) & COUNT_MASK);
+		assert(parties < PHASER_MAX_PARTIES);
+		if (mState.compare_exchange_weak(s, s + state(0, 1, 1), std::memory_order_acq_rel, std::memory_order_acquire))
+			return (uint32_t)(s >> PHASE_SHIFT);
+	}
+}
+
+uint32_t CPhaser::doArrive(bool deregister)
+{
+	uint64_t s = mState.load(std::memory_order_acquire);
+	uint32_t stamped = UINT32_MAX;
+	int64_t tm = esp_timer_get_time();
+	for (;;)
+	{
+		uint32_t phase = (uint32_t)(s >> PHASE_SHIFT);
+		uint32_t parties = (uint32_t)((s >> PARTIES_SHIFT) & COUNT_MASK);
+		uint32_t unarrived = (uint32_t)(s & COUNT_MASK);
+		assert(unarrived > 0);
+
+		if (!deregister && (stamped != phase))
+		{
+			// Время прибытия записывается до счетчика: завершающий фазу участник увидит время всех прибывших.
+			stamped = phase;
+			taskENTER_CRITICAL(&mStatMux);
+			if ((mFirstPhase != phase) || (tm < mFirstArrival))
+			{
+				mFirstPhase = phase;
+				mFirstArrival = tm;
+			}
+			taskEXIT_CRITICAL(&mStatMux);
+		}
+
+		if (deregister)
+			parties--;
+		// Последний прибывший одним обменом переводит фазу и восстанавливает счетчик неприбывших.
+		uint64_t next = (unarrived == 1) ? state(phase + 1, parties, parties) : (deregister ? (s - state(0, 1, 1)) : (s - 1));
+		if (mState.compare_exchange_weak(s, next, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			if (unarrived == 1)
+			{
+				taskENTER_CRITICAL(&mStatMux);
+				mStats.phases++;
+				mStats.lastSkew = ((mFirstPhase == phase) && (tm > mFirstArrival)) ? (tm - mFirstArrival) : 0;
+				if (mStats.lastSkew > mStats.maxSkew)
+					mStats.maxSkew = mStats.lastSkew;
+				taskEXIT_CRITICAL(&mStatMux);
+				signal();
+			}
+			return phase;
+		}
+	}
+}
+
+void CPhaser::signal()
+{
+	// Оповещения разных фаз могут выполняться одновременно, если завершивший фазу участник вытеснен.
+	// Под мьютексом объявляется текущая фаза: последнее оповещение всегда соответствует последней фазе.
+	xSemaphoreTake(mSignalMutex, portMAX_DELAY);
+	uint32_t phase = getPhase();
+	// Ожидающие фазу (phase - 2) уже прибыли в (phase - 1), поэтому бит фазы phase можно сбросить.
+	xEventGroupClearBits(mEvents, BIT(phase & 1));
+	mPhase.store(phase, std::memory_order_release);
+	xEventGroupSetBits(mEvents, BIT((phase - 1) & 1));
+	xSemaphoreGive(mSignalMutex);
+}
+
+bool CPhaser::awaitAdvance(uint32_t phase, TickType_t xTicksToWait)
+{
+	int64_t tm = esp_timer_get_time();
+	bool spinHit = false;
+	bool res = false;
+
+	for (uint32_t i = 0; i <= mSpin; i++)
+	{
+		// Объявленная фаза может отставать от состояния, но не опережать его.
+		if ((int32_t)(mPhase.load(std::memory_order_acquire) - phase) > 0)
+		{
+			spinHit = true;
+			res = true;
+			break;
+		}
+	}
+	if (!res && (getPhase() == phase))
+	{
+		// Если оповещение о прошлой фазе еще не выполнено, то бит этой фазы может остаться от нее: оповещаем сами.
+		if (mPhase.load(std::memory_order_acquire) != phase)
+			signal();
+		EventBits_t bits = xEventGroupWaitBits(mEvents, BIT(phase & 1), pdFALSE, pdTRUE, xTicksToWait);
+		res = ((bits & BIT(phase & 1)) != 0) || (getPhase() != phase);
+	}
+	else
+	{
+		res = true;
+	}
+
+	tm = esp_timer_get_time() - tm;
+	taskENTER_CRITICAL(&mStatMux);
+	mStats.waits++;
+	if (spinHit)
+		mStats.spinHits++;
+	if (!res)
+		mStats.timeouts++;
+	mStats.totalWait += tm;
+	if (tm > mStats.maxWait)
+		mStats.maxWait = tm;
+	taskEXIT_CRITICAL(&mStatMux);
+	return res;
+}
+
+void CPhaser::getStats(SPhaserStats *stats)
+{
+	assert(stats != nullptr);
+
+	taskENTER_CRITICAL(&mStatMux);
+	*stats = mStats;
+	taskEXIT_CRITICAL(&mStatMux);
+}
+
+void CPhaser::resetStats()
+{
+	taskENTER_CRITICAL(&mStatMux);
+	std::memset(&mStats, 0, sizeof(mStats));
+	taskEXIT_CRITICAL(&mStatMux);
+}
@@ -9,6 +9,16 @@
 #include "CPrintLog.h"
 #include "esp_log.h"
 
+CPrintLog::CPrintLog() : ITraceLog(), CLock("PrintLog")
+{
+    CLock::init(xSemaphoreCreateMutex());
+}
+
+CPrintLog::~CPrintLog()
+{
+    vSemaphoreDelete(mMutex);
+}
+
 void CPrintLog::printHeader(uint64_t time, uint32_t n)
 {
     uint64_t res = time / n;
@@ -43,6 +53,7 @@ void CPrintLog::printHeader(uint64_t time, uint32_t n)
 
 void CPrintLog::trace(const char *strError, int32_t errCode, esp_log_level_t level, bool reboot)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     if (errCode != 0x7fffffff)
     {
@@ -106,6 +117,7 @@ void CPrintLog::trace(const char *strError, int32_t errCode, esp_log_level_t lev
 
 void CPrintLog::trace(const char *strError, uint8_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -124,6 +136,7 @@ void CPrintLog::trace(const char *strError, uint8_t *data, uint32_t size)
 
 void CPrintLog::trace(const char *strError, int8_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -142,6 +155,7 @@ void CPrintLog::trace(const char *strError, int8_t *data, uint32_t size)
 
 void CPrintLog::trace(const char *strError, uint16_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -160,6 +174,7 @@ void CPrintLog::trace(const char *strError, uint16_t *data, uint32_t size)
 
 void CPrintLog::trace(const char *strError, int16_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -178,6 +193,7 @@ void CPrintLog::trace(const char *strError, int16_t *data, uint32_t size)
 
 void CPrintLog::trace(const char *strError, uint32_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -196,6 +212,7 @@ void CPrintLog::trace(const char *strError, uint32_t *data, uint32_t size)
 
 void CPrintLog::trace(const char *strError, int32_t *data, uint32_t size)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -214,6 +231,7 @@ void CPrintLog::trace(const char *strError, int32_t *data, uint32_t size)
 
 void CPrintLog::stopTime(const char *str, uint32_t n)
 {
+    TLockGuard<CLock> guard(*this);
     uint64_t res = getTimer();
     printHeader(res, n);
 #ifdef CONFIG_DEBUG_TRACE_ESPLOG
@@ -223,3 +241,17 @@ void CPrintLog::stopTime(const char *str, uint32_t n)
     std::printf(" %s\n", str);
 #endif
 }
+
+void CPrintLog::startTime()
+{
+    TLockGuard<CLock> guard(*this);
+    getTimer();
+}
+
+void CPrintLog::log(const char *str)
+{
+    TLockGuard<CLock> guard(*this);
+    if (str != nullptr)
+        std::printf(str);
+    std::printf("\n");
+}
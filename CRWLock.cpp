@@ -0,0 +1,105 @@
+/*!
+	\file
+	\brief Захват ресурса с разделяемым доступом для чтения.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CRWLock.h"
+
+#define RWLOCK_WRITER (1u << 31)		   ///< Бит писателя в mState.
+#define RWLOCK_READERS (RWLOCK_WRITER - 1) ///< Маска количества читателей в mState.
+
+#define RWLOCK_NO_WRITER_BIT (1 << 0) ///< Событие: писателя нет.
+#define RWLOCK_DRAINED_BIT (1 << 1)	  ///< Событие: читатели вышли.
+
+CRWLock::CRWLock(const char *name) : CLock(name)
+{
+	CLock::init(xSemaphoreCreateMutex());
+	mEvents = xEventGroupCreate();
+	xEventGroupSetBits(mEvents, RWLOCK_NO_WRITER_BIT);
+}
+
+CRWLock::~CRWLock()
+{
+	vEventGroupDelete(mEvents);
+	vSemaphoreDelete(mMutex);
+}
+
+void CRWLock::lock()
+{
+	tryLock(portMAX_DELAY);
+}
+
+bool CRWLock::tryLock(TickType_t xTicksToWait)
+{
+	TickType_t start = xTaskGetTickCount();
+	if (!CLock::tryLock(xTicksToWait))
+		return false;
+
+	// Событие "читатели вышли" может остаться от прошлого писателя, поэтому сбрасывается до выставления бита писателя.
+	xEventGroupClearBits(mEvents, RWLOCK_NO_WRITER_BIT | RWLOCK_DRAINED_BIT);
+	if ((mState.fetch_or(RWLOCK_WRITER, std::memory_order_acquire) & RWLOCK_READERS) == 0)
+		return true;
+
+	TickType_t wait = portMAX_DELAY;
+	if (xTicksToWait != portMAX_DELAY)
+	{
+		TickType_t elapsed = xTaskGetTickCount() - start;
+		wait = (elapsed >= xTicksToWait) ? 0 : (xTicksToWait - elapsed);
+	}
+	if ((xEventGroupWaitBits(mEvents, RWLOCK_DRAINED_BIT, pdTRUE, pdTRUE, wait) & RWLOCK_DRAINED_BIT) != 0)
+		return true;
+	if ((mState.load(std::memory_order_acquire) & RWLOCK_READERS) == 0)
+		return true; // читатели вышли одновременно с таймаутом
+
+	// Таймаут: читатели продолжают работу, ожидающие писателя читатели отпускаются.
+	unlock();
+	return false;
+}
+
+void CRWLock::unlock()
+{
+	mState.fetch_and(~RWLOCK_WRITER, std::memory_order_release);
+	xEventGroupSetBits(mEvents, RWLOCK_NO_WRITER_BIT);
+	CLock::unlock();
+}
+
+void CRWLock::lockShared()
+{
+	tryLockShared(portMAX_DELAY);
+}
+
+bool CRWLock::tryLockShared(TickType_t xTicksToWait)
+{
+	TickType_t start = xTaskGetTickCount();
+	uint32_t st = mState.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		if ((st & RWLOCK_WRITER) == 0)
+		{
+			if (mState.compare_exchange_weak(st, st + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+			continue;
+		}
+
+		TickType_t wait = portMAX_DELAY;
+		if (xTicksToWait != portMAX_DELAY)
+		{
+			TickType_t elapsed = xTaskGetTickCount() - start;
+			if (elapsed >= xTicksToWait)
+				return false;
+			wait = xTicksToWait - elapsed;
+		}
+		xEventGroupWaitBits(mEvents, RWLOCK_NO_WRITER_BIT, pdFALSE, pdTRUE, wait);
+		st = mState.load(std::memory_order_relaxed);
+	}
+}
+
+void CRWLock::unlockShared()
+{
+	uint32_t st = mState.fetch_sub(1, std::memory_order_release);
+	if (st == (RWLOCK_WRITER | 1))
+		xEventGroupSetBits(mEvents, RWLOCK_DRAINED_BIT);
+}
@@ -0,0 +1,74 @@
+/*!
+	\file
+	\brief Захват ресурса активным ожиданием для очень коротких критических секций.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CSpinLock.h"
+#include <cassert>
+#include "esp_cpu.h"
+
+#define SPINLOCK_BACKOFF_MAX 64 ///< Максимальная пауза между попытками захвата (циклов).
+
+CSpinLock::CSpinLock(uint32_t maxHold)
+{
+#ifndef NDEBUG
+	mMaxHold = maxHold;
+#else
+	(void)maxHold;
+#endif
+}
+
+void IRAM_ATTR CSpinLock::lock()
+{
+	UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+#ifndef NDEBUG
+	assert(mOwnerCore != esp_cpu_get_core_id()); // повторный захват на том же ядре
+#endif
+	uint32_t backoff = 1;
+	for (;;)
+	{
+		// Запись только при свободном ресурсе: ожидание не гоняет строку кэша между ядрами.
+		if ((mFlag.load(std::memory_order_relaxed) == 0) && (mFlag.exchange(1, std::memory_order_acquire) == 0))
+			break;
+		for (uint32_t i = 0; i < backoff; i++)
+			__asm__ __volatile__("nop");
+		if (backoff < SPINLOCK_BACKOFF_MAX)
+			backoff <<= 1;
+	}
+	mIntState = state;
+#ifndef NDEBUG
+	mOwnerCore = esp_cpu_get_core_id();
+	mLockCycle = esp_cpu_get_cycle_count();
+#endif
+}
+
+bool IRAM_ATTR CSpinLock::tryLock()
+{
+	UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+	if ((mFlag.load(std::memory_order_relaxed) != 0) || (mFlag.exchange(1, std::memory_order_acquire) != 0))
+	{
+		portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+		return false;
+	}
+	mIntState = state;
+#ifndef NDEBUG
+	mOwnerCore = esp_cpu_get_core_id();
+	mLockCycle = esp_cpu_get_cycle_count();
+#endif
+	return true;
+}
+
+void IRAM_ATTR CSpinLock::unlock()
+{
+#ifndef NDEBUG
+	assert(mOwnerCore == esp_cpu_get_core_id());
+	assert((esp_cpu_get_cycle_count() - mLockCycle) <= mMaxHold);
+	mOwnerCore = -1;
+#endif
+	UBaseType_t state = mIntState;
+	mFlag.store(0, std::memory_order_release);
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
@@ -0,0 +1,247 @@
+/*!
+	\file
+	\brief Балансировщик загрузки ядер CPU для задач CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CTaskBalancer.h"
+
+#ifdef CONFIG_TASK_BALANCER
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include "esp_idf_version.h"
+#include "esp_log.h"
+#include "CTrace.h"
+
+static const char *TAG = "TaskBalancer";
+
+/// Хэндлер задачи idle ядра CPU.
+/*!
+  \param[in] coreID Ядро CPU.
+  \return Хэндлер задачи.
+*/
+static inline TaskHandle_t getIdleTask(BaseType_t coreID)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+	return xTaskGetIdleTaskHandleForCore(coreID);
+#else
+	return xTaskGetIdleTaskHandleForCPU(coreID);
+#endif
+}
+
+CTaskBalancer::CTaskBalancer() : CBaseTask(), CLock(TAG)
+{
+	CLock::init(xSemaphoreCreateMutex());
+}
+
+CTaskBalancer::~CTaskBalancer()
+{
+	if (mStatus != nullptr)
+		vPortFree(mStatus);
+	vSemaphoreDelete(mMutex);
+}
+
+void CTaskBalancer::init(uint32_t period, uint8_t threshold, uint8_t hysteresis, BaseType_t coreID)
+{
+	assert(period > 0);
+	assert(hysteresis > 0);
+
+	mPeriod = period;
+	mState.threshold = threshold;
+	mState.hysteresis = hysteresis;
+	CBaseTask::init("balancer", 3072, configMAX_PRIORITIES - 2, 4, coreID);
+}
+
+void CTaskBalancer::add(CBaseTask *task)
+{
+	assert(task != nullptr);
+
+	lock();
+	m_list.push_back({task, nullptr, 0, 0});
+	unlock();
+}
+
+void CTaskBalancer::remove(CBaseTask *task)
+{
+	lock();
+	m_list.remove_if([task](const SBalancerEntry &x)
+					 { return x.task == task; });
+	unlock();
+}
+
+void CTaskBalancer::run()
+{
+	STaskMessage msg;
+
+	sample();
+	for (;;)
+	{
+		if (getMessage(&msg, pdMS_TO_TICKS(mPeriod)))
+		{
+			if (msg.msgID == MSG_BALANCER_STOP)
+				break;
+			TRACE_WARNING("CTaskBalancer unknown message", msg.msgID);
+		}
+		else if (sample())
+		{
+			balance();
+		}
+	}
+}
+
+bool CTaskBalancer::sample()
+{
+	UBaseType_t n = uxTaskGetNumberOfTasks() + 4;
+	if (n > mStatusSize)
+	{
+		if (mStatus != nullptr)
+			vPortFree(mStatus);
+		mStatus = (TaskStatus_t *)pvPortMalloc(n * sizeof(TaskStatus_t));
+		mStatusSize = (mStatus != nullptr) ? n : 0;
+		if (mStatus == nullptr)
+		{
+			TRACE_ERROR("CTaskBalancer:no memory", n);
+			return false;
+		}
+	}
+
+	configRUN_TIME_COUNTER_TYPE total;
+	n = uxTaskGetSystemState(mStatus, mStatusSize, &total);
+	configRUN_TIME_COUNTER_TYPE dt = total - mTotalTime;
+	mTotalTime = total;
+	if ((n == 0) || (dt == 0))
+		return false;
+
+	for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+	{
+		TaskHandle_t idle = getIdleTask(core);
+		for (UBaseType_t i = 0; i < n; i++)
+		{
+			if (mStatus[i].xHandle == idle)
+			{
+				configRUN_TIME_COUNTER_TYPE t = mStatus[i].ulRunTimeCounter - mIdleTime[core];
+				mIdleTime[core] = mStatus[i].ulRunTimeCounter;
+				mCoreLoad[core] = 100 - percent(t, dt);
+				break;
+			}
+		}
+	}
+
+	lock();
+	for (auto &x : m_list)
+	{
+		x.load = 0;
+		for (UBaseType_t i = 0; i < n; i++)
+		{
+			if (mStatus[i].xHandle == x.task->getTask())
+			{
+				configRUN_TIME_COUNTER_TYPE t = mStatus[i].ulRunTimeCounter - x.runTime;
+				x.runTime = mStatus[i].ulRunTimeCounter;
+				if (x.handle == mStatus[i].xHandle)
+					x.load = percent(t, dt);
+				else
+					x.handle = mStatus[i].xHandle; // задача пересоздана, замер с нуля
+				break;
+			}
+		}
+	}
+	unlock();
+	return true;
+}
+
+int CTaskBalancer::decide(SBalanceState &state, const uint8_t *coreLoad, const SBalanceLoad *tasks, int count, BaseType_t &from, BaseType_t &to)
+{
+	assert(coreLoad != nullptr);
+	assert((tasks != nullptr) || (count == 0));
+
+	from = 0;
+	to = 0;
+	for (BaseType_t core = 1; core < portNUM_PROCESSORS; core++)
+	{
+		if (coreLoad[core] > coreLoad[from])
+			from = core;
+		if (coreLoad[core] < coreLoad[to])
+			to = core;
+	}
+	int diff = coreLoad[from] - coreLoad[to];
+
+	if (state.cooldown > 0)
+		state.cooldown--;
+	if (diff <= state.threshold)
+	{
+		state.imbalance = 0;
+		return -1;
+	}
+	if (state.imbalance < state.hysteresis)
+		state.imbalance++;
+	if ((state.imbalance < state.hysteresis) || (state.cooldown > 0))
+		return -1;
+
+	// Перенос задачи с загрузкой L меняет разницу на 2L, поэтому ищем задачу с загрузкой, ближайшей к diff/2.
+	int best = -1;
+	for (int i = 0; i < count; i++)
+	{
+		const SBalanceLoad &x = tasks[i];
+		if (!x.migratable || (x.core != from) || (x.load == 0) || (x.load >= diff))
+			continue;
+		if ((best < 0) || (std::abs(diff - 2 * x.load) < std::abs(diff - 2 * tasks[best].load)))
+			best = i;
+	}
+	if (best >= 0)
+	{
+		state.imbalance = 0;
+		state.cooldown = state.hysteresis;
+	}
+	return best;
+}
+
+void CTaskBalancer::balance()
+{
+	lock();
+	mLoads.clear();
+	for (auto &x : m_list)
+		mLoads.push_back({x.task->getCore(), x.load, x.task->isMigratable()});
+	BaseType_t from;
+	BaseType_t to;
+	int i = decide(mState, mCoreLoad, mLoads.data(), (int)mLoads.size(), from, to);
+	if (i >= 0)
+	{
+		auto it = m_list.begin();
+		std::advance(it, i);
+		SBalanceDecision d;
+		std::strncpy(d.name, pcTaskGetName(it->task->getTask()), sizeof(d.name) - 1);
+		d.name[sizeof(d.name) - 1] = 0;
+		// Если перенос не удался, то следующая попытка - после паузы.
+		if (it->task->migrate(to))
+		{
+			d.time = esp_timer_get_time();
+			d.from = from;
+			d.to = to;
+			d.taskLoad = it->load;
+			for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+				d.coreLoad[core] = mCoreLoad[core];
+			mDecisions.push(d);
+			mDecisionCount++;
+			ESP_LOGI(TAG, "%s(%d%%): core %d(%d%%) -> core %d(%d%%)", d.name, d.taskLoad, d.from, mCoreLoad[from], d.to, mCoreLoad[to]);
+		}
+	}
+	unlock();
+}
+
+void CTaskBalancer::printLog()
+{
+	int n = (mDecisionCount < (uint32_t)mDecisions.getSize()) ? mDecisionCount : mDecisions.getSize();
+	ESP_LOGI(TAG, "decisions: %ld", (long)mDecisionCount);
+	for (int i = -n; i < 0; i++)
+	{
+		SBalanceDecision &d = mDecisions[i];
+		ESP_LOGI(TAG, "%lld: %s(%d%%) core %d -> core %d", (long long)d.time, d.name, d.taskLoad, d.from, d.to);
+	}
+}
+
+#endif // CONFIG_TASK_BALANCER
@@ -0,0 +1,111 @@
+/*!
+	\file
+	\brief Пул задач для коротких заданий без создания и удаления задач FreeRTOS.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CTaskPool.h"
+#include <cstdio>
+#include <cstring>
+#include "CTrace.h"
+
+void CPoolTask::run()
+{
+	STaskMessage msg;
+	uint32_t bits;
+	for (;;)
+	{
+		if (!getMessage(&msg, portMAX_DELAY) || (msg.msgID != MSG_POOL_START))
+			continue;
+
+		mJob(this, mArg);
+
+		// Очистка состояния задания: задача возвращается в пул пустой.
+		mJob = nullptr;
+		mArg = nullptr;
+		mNotify = 0;
+		mSpinMax = 0;
+		xQueueReset(mTaskQueue);
+		xTaskNotifyWait(0, 0xffffffff, &bits, 0);
+		mPool->release(this);
+	}
+}
+
+CTaskPool::CTaskPool() : CLock("TaskPool")
+{
+	CLock::init(xSemaphoreCreateMutex());
+}
+
+CTaskPool::~CTaskPool()
+{
+	assert(mStats.idle == mStats.size);
+	delete[] mTasks;
+	delete[] mIdle;
+	if (mAvailable != nullptr)
+		vSemaphoreDelete(mAvailable);
+	vSemaphoreDelete(mMutex);
+}
+
+void CTaskPool::init(const char *name, uint16_t size, unsigned short usStack, UBaseType_t uxPriority, UBaseType_t queueLength, BaseType_t coreID)
+{
+	assert(mTasks == nullptr);
+	assert(size > 0);
+	assert((std::strlen(name) + 3) < configMAX_TASK_NAME_LEN);
+
+	mTasks = new CPoolTask[size];
+	mIdle = new CPoolTask *[size];
+	mAvailable = xSemaphoreCreateCounting(size, size);
+	char str[configMAX_TASK_NAME_LEN];
+	for (uint16_t i = 0; i < size; i++)
+	{
+		std::snprintf(str, sizeof(str), "%s%d", name, i);
+		mTasks[i].mPool = this;
+		mTasks[i].init(str, usStack, uxPriority, queueLength, coreID);
+		mIdle[i] = &mTasks[i];
+	}
+	mStats.size = size;
+	mStats.idle = size;
+}
+
+CPoolTask *CTaskPool::start(pool_job_t job, void *arg, TickType_t xTicksToWait)
+{
+	assert(job != nullptr);
+
+	if ((mAvailable == nullptr) || (xSemaphoreTake(mAvailable, xTicksToWait) != pdTRUE))
+	{
+		lock();
+		mStats.failed++;
+		unlock();
+		return nullptr;
+	}
+
+	lock();
+	CPoolTask *task = mIdle[--mStats.idle];
+	mStats.started++;
+	uint16_t busy = mStats.size - mStats.idle;
+	if (busy > mStats.peakBusy)
+		mStats.peakBusy = busy;
+	unlock();
+
+	task->mJob = job;
+	task->mArg = arg;
+	task->sendCmd(MSG_POOL_START);
+	return task;
+}
+
+void CTaskPool::release(CPoolTask *task)
+{
+	lock();
+	mIdle[mStats.idle++] = task;
+	unlock();
+	xSemaphoreGive(mAvailable);
+}
+
+void CTaskPool::getStats(SPoolStats *stats)
+{
+	lock();
+	*stats = mStats;
+	unlock();
+}
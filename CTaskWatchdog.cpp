@@ -0,0 +1,139 @@
+/*!
+	\file
+	\brief Контроль времени обслуживания очередей задач CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "CTaskWatchdog.h"
+
+#ifdef CONFIG_TASK_WATCHDOG
+
+#include "esp_timer.h"
+#include <algorithm>
+#include "CTrace.h"
+
+static const char *TAG = "TaskWatchdog";
+
+CTaskWatchdog::CTaskWatchdog() : CBaseTask(), CLock(TAG)
+{
+	CLock::init(xSemaphoreCreateMutex());
+}
+
+CTaskWatchdog::~CTaskWatchdog()
+{
+	vSemaphoreDelete(mMutex);
+}
+
+void CTaskWatchdog::init(uint32_t period, BaseType_t coreID)
+{
+	assert(period > 0);
+
+	mPeriod = period;
+	CBaseTask::init("watchdog", 3072, configMAX_PRIORITIES - 1, 4, coreID);
+}
+
+void CTaskWatchdog::add(CBaseTask *task, int64_t drainLimit, int64_t pendingLimit, watchdog_cb_t cb, void *arg)
+{
+	assert(task != nullptr);
+
+	lock();
+	m_list.push_back({task, drainLimit, pendingLimit, cb, arg, false});
+	unlock();
+}
+
+void CTaskWatchdog::remove(CBaseTask *task)
+{
+	lock();
+	m_list.remove_if([task](const SWatchdogEntry &x)
+					 { return x.task == task; });
+	unlock();
+}
+
+void CTaskWatchdog::getState(CBaseTask *task, SWatchdogState *state)
+{
+	assert(task != nullptr);
+	assert(state != nullptr);
+
+	int64_t tm = esp_timer_get_time();
+	state->task = task;
+	state->queued = task->getQueueCount();
+	if (state->queued == 0)
+	{
+		state->drainAge = 0;
+		state->pendingAge = 0;
+	}
+	else
+	{
+		state->drainAge = tm - task->getLastDrain();
+		int64_t since = task->getPendingSince();
+		state->pendingAge = (since == 0) ? 0 : (tm - since);
+	}
+	if (task->getTask() != nullptr)
+	{
+		state->state = eTaskGetState(task->getTask());
+		state->stackFree = uxTaskGetStackHighWaterMark(task->getTask());
+	}
+	else
+	{
+		state->state = eDeleted;
+		state->stackFree = 0;
+	}
+}
+
+void CTaskWatchdog::run()
+{
+	STaskMessage msg;
+
+	for (;;)
+	{
+		if (getMessage(&msg, pdMS_TO_TICKS(mPeriod)))
+		{
+			if (msg.msgID == MSG_WATCHDOG_STOP)
+				break;
+			TRACE_WARNING("CTaskWatchdog unknown message", msg.msgID);
+		}
+		else
+		{
+			check();
+		}
+	}
+}
+
+void CTaskWatchdog::check()
+{
+	SWatchdogState state;
+
+	lock();
+	for (auto &x : m_list)
+	{
+		if (!x.task->isRun())
+			continue;
+		getState(x.task, &state);
+
+		bool violation = ((x.drainLimit > 0) && (state.drainAge > x.drainLimit)) ||
+						 ((x.pendingLimit > 0) && (state.pendingAge > x.pendingLimit));
+		if (violation && !x.fired)
+		{
+			x.fired = true;
+			mViolations++;
+			// Состояние задачи выводится и без функции обратного вызова.
+			TRACE_WARNING(pcTaskGetName(x.task->getTask()), (int32_t)(std::max(state.drainAge, state.pendingAge) / 1000));
+			TRACE_WARNING("  queued", (int32_t)state.queued);
+			TRACE_WARNING("  drain age, ms", (int32_t)(state.drainAge / 1000));
+			TRACE_WARNING("  pending age, ms", (int32_t)(state.pendingAge / 1000));
+			TRACE_WARNING("  task state", (int32_t)state.state);
+			TRACE_WARNING("  stack free", (int32_t)state.stackFree);
+			if (x.cb != nullptr)
+				x.cb(&state, x.arg);
+		}
+		else if (!violation)
+		{
+			x.fired = false;
+		}
+	}
+	unlock();
+}
+
+#endif // CONFIG_TASK_WATCHDOG
@@ -7,6 +7,7 @@
 */
 
 #include "CTrace.h"
+#include <cstring>
 #include "esp_system.h"
 #include "esp_log.h"
 #include "CPrintLog.h"
@@ -22,13 +23,16 @@ CPrintLog tracePrintLog;
 
 static const char *TAG = "TraceList";
 
-CTraceList::CTraceList() : ITraceLog(), CLock()
+ITraceLog *CTraceList::mEmpty[1] = {nullptr};
+thread_local uint32_t CTraceList::mDepth = 0;
+
+CTraceList::CTraceList() : ITraceLog(), CLock(TAG), mSinks(mEmpty)
 {
+	CLock::init(xSemaphoreCreateMutex());
 	if (esp_timer_early_init() != ESP_OK)
 	{
 		ESP_LOGE(TAG, "esp_timer_early_init error");
 	}
-	vSemaphoreCreateBinary(mMutex);
 }
 
 CTraceList::~CTraceList()
@@ -52,25 +56,41 @@ void CTraceList::init()
 #endif
 }
 
+ITraceLog **CTraceList::replace(ITraceLog **sinks)
+{
+	// Из trace() трассировщика ожидание читателей никогда не закончится.
+	assert(mDepth == 0);
+
+	ITraceLog **old = mSinks.exchange(sinks, std::memory_order_seq_cst);
+	// Старый массив могут читать только читатели текущего поколения: вошедшие после смены поколения получат новый массив.
+	uint32_t gen = mGeneration.load(std::memory_order_relaxed);
+	mGeneration.store(gen ^ 1, std::memory_order_seq_cst);
+	while (mReaders[gen].load(std::memory_order_seq_cst) != 0)
+		vTaskDelay(1);
+	return old;
+}
+
 void CTraceList::clear()
 {
 	lock();
-	for (auto x : m_list)
+	ITraceLog **old = replace(mEmpty);
+	for (ITraceLog **x = old; *x != nullptr; x++)
 	{
-		delete x;
+		delete *x;
 	}
-	m_list.clear();
+	if (old != mEmpty)
+		delete[] old;
 	unlock();
 }
 
 void CTraceList::trace(const char *strError, int32_t errCode, esp_log_level_t level, bool reboot)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, errCode, level, reboot);
+		(*x)->trace(strError, errCode, level, reboot);
 	}
-	unlock();
+	leave(gen);
 
 	if (reboot)
 	{
@@ -82,114 +102,143 @@ void CTraceList::trace(const char *strError, int32_t errCode, esp_log_level_t le
 
 void CTraceList::traceFromISR(const char *strError, int32_t errCode, esp_log_level_t level, bool reboot, BaseType_t *pxHigherPriorityTaskWoken)
 {
-	// lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->traceFromISR(strError, errCode, level, reboot, pxHigherPriorityTaskWoken);
+		(*x)->traceFromISR(strError, errCode, level, reboot, pxHigherPriorityTaskWoken);
 	}
-	// unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, uint8_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, int8_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, uint16_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, int16_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, uint32_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::trace(const char *strError, int32_t *data, uint32_t size)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->trace(strError, data, size);
+		(*x)->trace(strError, data, size);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::log(const char *str)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->log(str);
+		(*x)->log(str);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::startTime()
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->startTime();
+		(*x)->startTime();
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::stopTime(const char *str, uint32_t n)
 {
-	lock();
-	for (auto x : m_list)
+	uint32_t gen;
+	for (ITraceLog **x = enter(gen); *x != nullptr; x++)
 	{
-		x->stopTime(str, n);
+		(*x)->stopTime(str, n);
 	}
-	unlock();
+	leave(gen);
 }
 
 void CTraceList::add(ITraceLog *log)
 {
 	lock();
-	m_list.push_back(log);
+	ITraceLog **old = mSinks.load(std::memory_order_relaxed);
+	size_t n = 0;
+	while (old[n] != nullptr)
+		n++;
+	ITraceLog **sinks = new ITraceLog *[n + 2];
+	std::memcpy(sinks, old, n * sizeof(ITraceLog *));
+	sinks[n] = log;
+	sinks[n + 1] = nullptr;
+	if (replace(sinks) != mEmpty)
+		delete[] old;
 	unlock();
 }
 
 void CTraceList::remove(ITraceLog *log)
 {
 	lock();
-	m_list.remove(log);
+	ITraceLog **old = mSinks.load(std::memory_order_relaxed);
+	size_t n = 0;
+	for (size_t i = 0; old[i] != nullptr; i++)
+	{
+		if (old[i] != log)
+			n++;
+	}
+	ITraceLog **sinks = mEmpty;
+	if (n != 0)
+	{
+		sinks = new ITraceLog *[n + 1];
+		n = 0;
+		for (size_t i = 0; old[i] != nullptr; i++)
+		{
+			if (old[i] != log)
+				sinks[n++] = old[i];
+		}
+		sinks[n] = nullptr;
+	}
+	if (replace(sinks) != mEmpty)
+		delete[] old;
 	unlock();
 }
@@ -0,0 +1,50 @@
+/*!
+	\file
+	\brief Интерфейс распределителя памяти для тел сообщений STaskMessage.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#include "IMsgAllocator.h"
+
+IMsgAllocator *IMsgAllocator::mFirst = nullptr;
+portMUX_TYPE IMsgAllocator::mListMux = portMUX_INITIALIZER_UNLOCKED;
+
+IMsgAllocator::IMsgAllocator()
+{
+	taskENTER_CRITICAL(&mListMux);
+	mNext = mFirst;
+	mFirst = this;
+	taskEXIT_CRITICAL(&mListMux);
+}
+
+IMsgAllocator::~IMsgAllocator()
+{
+	taskENTER_CRITICAL(&mListMux);
+	for (IMsgAllocator **x = &mFirst; *x != nullptr; x = &(*x)->mNext)
+	{
+		if (*x == this)
+		{
+			*x = mNext;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL(&mListMux);
+}
+
+IMsgAllocator *IMsgAllocator::find(const void *ptr)
+{
+	IMsgAllocator *res = nullptr;
+	taskENTER_CRITICAL_SAFE(&mListMux);
+	for (IMsgAllocator *x = mFirst; x != nullptr; x = x->mNext)
+	{
+		if (x->owns(ptr))
+		{
+			res = x;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL_SAFE(&mListMux);
+	return res;
+}
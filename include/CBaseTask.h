@@ -9,9 +9,12 @@
 #if !defined CBASETASK_H
 #define CBASETASK_H
 
+#include <atomic>
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "IMsgAllocator.h"
 
 /// Структура сообщения между задачами.
 struct STaskMessage
@@ -30,6 +33,26 @@ struct STaskMessage
 	};
 };
 
+/// События задачи, полученные через CBaseTask::waitAny().
+struct STaskEvents
+{
+	uint32_t bits;	///< Биты уведомления (таймеры, внешние события) без бита очереди сообщений.
+	uint16_t count; ///< Количество принятых из очереди сообщений.
+};
+
+/// Статистика приема сообщений с активным ожиданием.
+struct SSpinStats
+{
+	uint32_t immediate; ///< Количество сообщений, уже бывших в очереди.
+	uint32_t spinHits;	///< Количество сообщений, дождавшихся активным ожиданием.
+	uint32_t blocks;	///< Количество блокирующих ожиданий.
+	uint32_t budget;	///< Текущий бюджет активного ожидания в тактах CPU.
+};
+
+#ifdef CONFIG_TASK_RECORDER
+class CMsgRecorder;
+#endif
+
 /// Базовый абстрактный класс для реализации задачи FreeRTOS.
 class CBaseTask
 {
@@ -38,6 +61,47 @@ protected:
 	QueueHandle_t mTaskQueue = nullptr; ///< Приемная очередь сообщений.
 	uint32_t mNotify = 0; 				///< Флаг очереди сообщений для Notify. Если 0, то не используется.
 
+	unsigned short mStack = 0;			 ///< Размер стека задачи.
+	UBaseType_t mPriority = 0;			 ///< Приоритет задачи.
+	BaseType_t mCoreID = tskNO_AFFINITY; ///< Ядро CPU, на котором запущена задача.
+	bool mMigratable = false;			 ///< Флаг разрешения переноса задачи на другое ядро.
+	bool mStatic = false;				 ///< Флаг задачи со статически выделенной памятью.
+	volatile BaseType_t mMigrateTo = -1; ///< Ядро для переноса задачи. Если -1, то перенос не запрошен.
+
+	std::atomic<uint32_t> mReady{0}; ///< Флаг нового сообщения для активного ожидания.
+	uint32_t mSpinMax = 0;			 ///< Максимальный бюджет активного ожидания в тактах CPU. Если 0, то не используется.
+	bool mSpinAdaptive = false;		 ///< Флаг подстройки бюджета по интервалам между сообщениями.
+	uint32_t mLastArrival = 0;		 ///< Такт CPU последнего принятого сообщения.
+	uint32_t mArrivalAvg = 0;		 ///< Средний интервал между сообщениями в тактах CPU.
+	SSpinStats mSpinStats = {};		 ///< Статистика активного ожидания.
+
+	/// Прием сообщения с активным ожиданием.
+	/*!
+	  \param[out] msg Указатель на сообщение.
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true в случае успеха.
+	*/
+	bool spinMessage(STaskMessage *msg, TickType_t xTicksToWait);
+
+#ifdef CONFIG_TASK_WATCHDOG
+	// 64-битные метки не атомарны на 32-битном CPU, поэтому читаются и пишутся под mWatchdogMux.
+	portMUX_TYPE mWatchdogMux = portMUX_INITIALIZER_UNLOCKED; ///< Мьютекс меток времени очереди.
+	int64_t mPendingSince = 0;								  ///< Время последнего обслуживания непустой очереди (мкс). Если 0, то очередь пуста.
+	int64_t mLastDrain = 0;									  ///< Время последнего опустошения очереди (мкс).
+
+	/// Отметка об отправке сообщения в очередь.
+	void markSent();
+	/// Отметка о приеме сообщения из очереди.
+	/*!
+	  \param[in] received Признак принятого сообщения.
+	*/
+	void markReceived(bool received);
+#endif
+
+#ifdef CONFIG_TASK_RECORDER
+	CMsgRecorder *volatile mRecorder = nullptr; ///< Запись или воспроизведение принятых сообщений.
+#endif
+
 	/// Функция задачи FreeRTOS.
 	/*!
 	  \param[in] pvParameters Параметр (указатель на объект CBaseTask).
@@ -51,10 +115,28 @@ protected:
 	/*!
 	  \param[out] msg Указатель на сообщение.
 	  \param[in] xTicksToWait Время ожидания в тиках.
-	  \return true в случае успеха.
+	  \return true в случае успеха, false по таймауту или при запросе переноса задачи на другое ядро.
 	*/
 	bool getMessage(STaskMessage *msg, TickType_t xTicksToWait = 0);
 
+	/// Признак запрошенного переноса задачи на другое ядро.
+	/*!
+	  Переносимая задача должна выйти из run(), после чего run() будет запущена заново на новом ядре.
+	  \return true если перенос запрошен.
+	*/
+	inline bool isMigrating() { return mMigrateTo >= 0; };
+
+	/// Ожидание любого события: сообщений в очереди или битов уведомления.
+	/*!
+	  Очередь выбирается в buf без ожидания, пока есть место. Биты уведомления сбрасываются.
+	  Если mNotify == 0, то ожидание только по очереди, а биты уведомления проверяются без ожидания.
+	  \param[out] buf Буфер для сообщений.
+	  \param[in] size Размер буфера в сообщениях.
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return События. Пустые только по таймауту или при запросе переноса задачи.
+	*/
+	STaskEvents waitAny(STaskMessage *buf, uint16_t size, TickType_t xTicksToWait = portMAX_DELAY);
+
 public:
 	/// Начальная инициализация.
 	/*!
@@ -65,9 +147,40 @@ public:
 	  \param[in] coreID Ядро CPU (0,1).
 	*/
 	void init(const char *name, unsigned short usStack, UBaseType_t uxPriority, UBaseType_t queueLength, BaseType_t coreID = tskNO_AFFINITY);
+	/// Начальная инициализация со статически выделенной памятью.
+	/*!
+	  \param[in] name Имя задачи длиной не более configMAX_TASK_NAME_LEN.
+	  \param[in] usStack Размер стека.
+	  \param[in] uxPriority Приоритет. Не более configMAX_PRIORITIES.
+	  \param[in] queueLength Максимальная длина очереди сообщений.
+	  \param[in] stack Буфер стека размером usStack.
+	  \param[in] tcb Буфер структуры задачи.
+	  \param[in] queueBuffer Буфер очереди размером queueLength*sizeof(STaskMessage).
+	  \param[in] queue Буфер структуры очереди.
+	  \param[in] coreID Ядро CPU (0,1).
+	*/
+	void init(const char *name, unsigned short usStack, UBaseType_t uxPriority, UBaseType_t queueLength,
+			  StackType_t *stack, StaticTask_t *tcb, uint8_t *queueBuffer, StaticQueue_t *queue, BaseType_t coreID = tskNO_AFFINITY);
 	/// Деструктор.
 	virtual ~CBaseTask();
 
+	/// Включить прием сообщений с активным ожиданием.
+	/*!
+	  getMessage() с ненулевым временем ожидания сначала крутится на флаге нового сообщения, затем блокируется.
+	  waitAny() ждет уведомления задачи и активное ожидание не использует.
+	  Имеет смысл на многоядерных CPU для задач, латентность которых важнее загрузки ядра.
+	  \param[in] cycles Максимальное время активного ожидания в тактах CPU. Если 0, то выключено.
+	  \param[in] adaptive Подстраивать время по среднему интервалу между сообщениями, не больше cycles.
+	*/
+	void setSpinReceive(uint32_t cycles, bool adaptive = false);
+	/// Получить статистику активного ожидания.
+	/*!
+	  \param[out] stats Статистика.
+	*/
+	inline void getSpinStats(SSpinStats *stats) { *stats = mSpinStats; };
+	/// Вывести статистику активного ожидания.
+	void printSpinStats();
+
 	/// Послать сообщение в задачу из прерывания.
 	/*!
 	  \param[in] msg Указатель на сообщение.
@@ -116,6 +229,21 @@ public:
 	  \return указатель на выделенную память.
 	*/
 	static uint8_t *allocNewMsg(STaskMessage *msg, uint16_t cmd, uint16_t size);
+	/// Выделить память сообщению через распределитель.
+	/*!
+	  \param[in] msg Указатель на сообщение.
+	  \param[in] cmd Номер команды.
+	  \param[in] size Размер выделяемой памяти.
+	  \param[in] allocator Распределитель памяти. Если nullptr, то память выделяется из кучи.
+	  \return указатель на выделенную память.
+	*/
+	static uint8_t *allocNewMsg(STaskMessage *msg, uint16_t cmd, uint16_t size, IMsgAllocator *allocator);
+	/// Освободить память сообщения.
+	/*!
+	  Память возвращается распределителю, который ее выделил, или в кучу.
+	  \param[in] body Указатель на тело сообщения.
+	*/
+	static void freeMsg(void *body);
 
 	/// Признак запущенной задачи.
 	/*!
@@ -128,6 +256,72 @@ public:
 	  \return хэндлер задачи.
 	*/
 	inline TaskHandle_t getTask() {return mTaskHandle;};
+
+#ifdef CONFIG_TASK_WATCHDOG
+	/// Время последнего опустошения очереди.
+	/*!
+	  \return Время (мкс).
+	*/
+	inline int64_t getLastDrain()
+	{
+		taskENTER_CRITICAL(&mWatchdogMux);
+		int64_t res = mLastDrain;
+		taskEXIT_CRITICAL(&mWatchdogMux);
+		return res;
+	};
+	/// Время последнего обслуживания непустой очереди.
+	/*!
+	  Оценка сверху для времени поступления самого старого сообщения в очереди.
+	  \return Время (мкс). Если 0, то очередь пуста.
+	*/
+	inline int64_t getPendingSince()
+	{
+		taskENTER_CRITICAL(&mWatchdogMux);
+		int64_t res = mPendingSince;
+		taskEXIT_CRITICAL(&mWatchdogMux);
+		return res;
+	};
+	/// Количество сообщений в очереди.
+	/*!
+	  \return Количество сообщений.
+	*/
+	inline UBaseType_t getQueueCount() { return (mTaskQueue == nullptr) ? 0 : uxQueueMessagesWaiting(mTaskQueue); };
+#endif
+
+#ifdef CONFIG_TASK_RECORDER
+	/// Подключить запись принятых сообщений.
+	/*!
+	  \param[in] recorder Объект записи. Если nullptr, то отключить.
+	*/
+	inline void setRecorder(CMsgRecorder *recorder) { mRecorder = recorder; };
+#endif
+
+	/// Получить ядро CPU задачи.
+	/*!
+	  \return Ядро CPU или tskNO_AFFINITY.
+	*/
+	inline BaseType_t getCore() { return mCoreID; };
+
+	/// Разрешить перенос задачи на другое ядро.
+	/*!
+	  Функция run() переносимой задачи должна завершаться, если getMessage() вернул false и isMigrating() == true.
+	  \param[in] migratable Флаг разрешения переноса.
+	*/
+	inline void setMigratable(bool migratable = true) { mMigratable = migratable; };
+	/// Признак разрешения переноса задачи на другое ядро.
+	/*!
+	  \return Признак разрешения переноса.
+	*/
+	inline bool isMigratable() { return mMigratable; };
+
+	/// Перенести задачу на другое ядро.
+	/*!
+	  Если FreeRTOS поддерживает vTaskCoreAffinitySet, то задача переносится сразу.
+	  Иначе задаче выставляется запрос, и после выхода из run() она пересоздается на новом ядре с той же очередью.
+	  \param[in] coreID Ядро CPU.
+	  \return true в случае успеха.
+	*/
+	bool migrate(BaseType_t coreID);
 };
 
 #endif // CBASETASK_H
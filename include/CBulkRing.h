@@ -0,0 +1,149 @@
+/*!
+	\file
+	\brief Кольцо слотов общей памяти для передачи блоков данных между ядрами.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined CBULKRING_H
+#define CBULKRING_H
+
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "CBaseTask.h"
+
+#define BULKRING_ALIGN 64 ///< Выравнивание слотов и индексов на строку кэша.
+
+/// Кольцо предварительно выделенных слотов фиксированного размера.
+/*!
+  Один производитель и один потребитель. Данные пишутся и читаются прямо в слотах, без копирования и выделения памяти.
+  Производитель: acquire(), заполнение слота, commit().
+  Потребитель: front(), обработка слота, release().
+  Потребителю отправляется сообщение с номером слота (shortParam) и размером данных (paramID),
+  на каждый слот или только при переходе кольца из пустого в непустое состояние.
+  Получив сообщение, потребитель обрабатывает слоты, пока front() не вернет nullptr.
+*/
+class CBulkRing
+{
+protected:
+	// Индексы от 0 до 2*mSlots-1: так полное кольцо отличается от пустого при любом количестве слотов.
+	alignas(BULKRING_ALIGN) std::atomic<uint32_t> mHead{0}; ///< Индекс записи (производитель).
+	alignas(BULKRING_ALIGN) std::atomic<uint32_t> mTail{0}; ///< Индекс освобождения (потребитель).
+
+	uint8_t *mBuffer = nullptr;								///< Память слотов.
+	uint32_t *mSizes = nullptr;							///< Размер данных в слотах.
+	uint32_t mSlotSize;									///< Размер слота, кратный BULKRING_ALIGN.
+	uint16_t mSlots;									///< Количество слотов.
+	SemaphoreHandle_t mFree = nullptr;					///< Семафор освобождения слота в заполненном кольце.
+
+	CBaseTask *mTask = nullptr; ///< Задача потребителя.
+	uint16_t mMsgID = 0;		///< ID сообщения для потребителя.
+	bool mEdge = true;			///< Флаг отправки сообщения только для первого слота в пустом кольце.
+
+	uint32_t mPeak = 0;		   ///< Максимальное количество занятых слотов.
+	uint32_t mFull = 0;		   ///< Количество неудачных acquire() в заполненном кольце.
+	uint32_t mLost = 0;		   ///< Количество неотправленных сообщений потребителю.
+
+	/// Следующий индекс.
+	/*!
+	  \param[in] index Индекс.
+	  \return Индекс от 0 до 2*mSlots-1.
+	*/
+	inline uint32_t next(uint32_t index) { return (index == (2u * mSlots - 1)) ? 0 : (index + 1); };
+	/// Номер слота по индексу.
+	/*!
+	  \param[in] index Индекс.
+	  \return Номер слота.
+	*/
+	inline uint16_t position(uint32_t index) { return (index >= mSlots) ? (index - mSlots) : index; };
+	/// Количество занятых слотов.
+	/*!
+	  \param[in] head Индекс записи.
+	  \param[in] tail Индекс освобождения.
+	  \return Количество слотов.
+	*/
+	inline uint32_t count(uint32_t head, uint32_t tail) { return (head >= tail) ? (head - tail) : (head + 2u * mSlots - tail); };
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] slotSize Размер слота.
+	  \param[in] slots Количество слотов.
+	  \param[in] caps Тип памяти heap_caps_aligned_alloc.
+	*/
+	CBulkRing(uint32_t slotSize, uint16_t slots, uint32_t caps = MALLOC_CAP_DEFAULT);
+	/// Деструктор.
+	virtual ~CBulkRing();
+
+	/// Задать потребителя.
+	/*!
+	  \param[in] task Задача потребителя. Если nullptr, то сообщения не отправляются.
+	  \param[in] msgID ID сообщения.
+	  \param[in] edge Отправлять сообщение только при переходе кольца из пустого в непустое состояние.
+	*/
+	void setConsumer(CBaseTask *task, uint16_t msgID, bool edge = true);
+
+	/// Получить свободный слот (производитель).
+	/*!
+	  \param[in] xTicksToWait Время ожидания освобождения слота в тиках.
+	  \return Указатель на слот или nullptr, если кольцо заполнено.
+	*/
+	uint8_t *acquire(TickType_t xTicksToWait = 0);
+	/// Передать заполненный слот потребителю (производитель).
+	/*!
+	  \param[in] size Размер данных в слоте.
+	  \return Номер слота.
+	*/
+	uint16_t commit(uint32_t size);
+
+	/// Получить самый старый заполненный слот (потребитель).
+	/*!
+	  \param[out] size Размер данных в слоте.
+	  \return Указатель на слот или nullptr, если кольцо пустое.
+	*/
+	uint8_t *front(uint32_t *size = nullptr);
+	/// Получить слот по номеру из сообщения (потребитель).
+	/*!
+	  \param[in] index Номер слота.
+	  \return Указатель на слот.
+	*/
+	inline uint8_t *slot(uint16_t index) { return &mBuffer[index * mSlotSize]; };
+	/// Освободить самый старый заполненный слот (потребитель).
+	void release();
+
+	/// Размер слота.
+	/*!
+	  \return Размер слота, кратный BULKRING_ALIGN.
+	*/
+	inline uint32_t getSlotSize() { return mSlotSize; };
+	/// Количество слотов.
+	/*!
+	  \return Количество слотов.
+	*/
+	inline uint16_t getSlots() { return mSlots; };
+	/// Количество занятых слотов.
+	/*!
+	  \return Количество слотов.
+	*/
+	inline uint32_t getCount() { return count(mHead.load(std::memory_order_relaxed), mTail.load(std::memory_order_relaxed)); };
+	/// Максимальное количество занятых слотов.
+	/*!
+	  \return Количество слотов.
+	*/
+	inline uint32_t getPeak() { return mPeak; };
+	/// Количество неудачных acquire().
+	/*!
+	  \return Количество неудач.
+	*/
+	inline uint32_t getFull() { return mFull; };
+	/// Количество неотправленных сообщений потребителю.
+	/*!
+	  \return Количество сообщений.
+	*/
+	inline uint32_t getLost() { return mLost; };
+};
+
+#endif // CBULKRING_H
@@ -2,22 +2,71 @@
 	\file
 	\brief Базовый класс для захвата ресурса задач FreeRTOS.
     \authors Близнец Р.А. (r.bliznets@gmail.com)
-	\version 1.1.0.0
+	\version 1.2.0.0
 	\date 28.04.2020
 */
 
 #if !defined CLOCK_H
 #define CLOCK_H
 
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
+#ifdef CONFIG_LOCK_STATISTICS
+/// Статистика захвата ресурса.
+struct SLockStats
+{
+	const char *name;  ///< Имя ресурса.
+	uint32_t count;	   ///< Количество захватов.
+	uint32_t contended; ///< Количество захватов с ожиданием.
+	int64_t totalWait; ///< Суммарное время ожидания (мкс).
+	int64_t maxWait;   ///< Максимальное время ожидания (мкс).
+	int64_t maxHold;   ///< Максимальное время удержания (мкс).
+};
+#endif
+
+/// Захват ресурса на время жизни объекта.
+/*!
+  \tparam L Класс ресурса с методами lock() и unlock().
+*/
+template <class L>
+class TLockGuard
+{
+protected:
+	L &mLock; ///< Захваченный ресурс.
+
+public:
+	/// Конструктор с захватом ресурса.
+	/*!
+	  \param[in] lock Ресурс.
+	*/
+	explicit TLockGuard(L &lock) : mLock(lock) { mLock.lock(); };
+	/// Деструктор с освобождением ресурса.
+	~TLockGuard() { mLock.unlock(); };
+
+	TLockGuard(const TLockGuard &) = delete;
+	TLockGuard &operator=(const TLockGuard &) = delete;
+};
+
 /// Базовый класс для захвата ресурса.
 class CLock
 {
+	template <class L>
+	friend class TLockGuard;
+
 protected:
 	SemaphoreHandle_t mMutex = nullptr; ///< Хэндлер мьютекса.
 
+#ifdef CONFIG_LOCK_STATISTICS
+	SLockStats mStats = {}; ///< Статистика захвата.
+	int64_t mLockTime = 0;	///< Время последнего захвата (мкс).
+	CLock *mNext = nullptr; ///< Следующий ресурс в списке.
+
+	static CLock *mFirst;		  ///< Первый ресурс в списке.
+	static portMUX_TYPE mListMux; ///< Мьютекс списка ресурсов.
+#endif
+
 	/// Инициализация новыми параметрами.
 	/*!
 	  \param[in] mutex Указатель на на семафор для мьютекса.
@@ -29,12 +78,36 @@ protected:
 
 	/// Захват ресурса.
 	void lock();
+	/// Захват ресурса с ограничением времени ожидания.
+	/*!
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если ресурс захвачен.
+	*/
+	bool tryLock(TickType_t xTicksToWait = 0);
 	/// Освобождение ресурса.
 	void unlock();
 
 public:
 	/// Конструктор класса.
-	CLock();
+	/*!
+	  \param[in] name Имя ресурса для статистики.
+	*/
+	CLock(const char *name = nullptr);
+	/// Деструктор.
+	~CLock();
+
+#ifdef CONFIG_LOCK_STATISTICS
+	/// Получить статистику захвата.
+	/*!
+	  \param[out] stats Статистика.
+	*/
+	void getStats(SLockStats *stats);
+	/// Вывести статистику ресурсов с наибольшим суммарным временем ожидания.
+	/*!
+	  \param[in] top Количество ресурсов.
+	*/
+	static void printStats(uint8_t top = 5);
+#endif
 };
 
 #endif // CLOCK_H
@@ -0,0 +1,111 @@
+/*!
+	\file
+	\brief Распределитель памяти сообщений по циклам (эпохам).
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+
+	Тела сообщений одного цикла выделяются последовательно из одного банка памяти.
+	Банк сбрасывается целиком, когда все потребители подтвердили обработку его эпохи.
+*/
+
+#if !defined CMSGARENA_H
+#define CMSGARENA_H
+
+#include <atomic>
+#include "IMsgAllocator.h"
+#include "esp_heap_caps.h"
+
+/// Двухбанковый распределитель памяти сообщений по эпохам.
+/*!
+  Производители выделяют память через CBaseTask::allocNewMsg(msg, cmd, size, arena) в текущей эпохе.
+  Потребители не освобождают тела сообщений, а вызывают ack() после обработки всех сообщений эпохи.
+  Управляющая задача вызывает nextEpoch() в начале каждого цикла.
+*/
+class CMsgArena : public IMsgAllocator
+{
+protected:
+	uint8_t *mBuffer = nullptr; ///< Память двух банков.
+	uint32_t mSize;				///< Размер одного банка.
+	uint8_t mConsumers;			///< Количество потребителей.
+
+	std::atomic<uint32_t> mState{0};	 ///< Старший бит - текущий банк, остальные - смещение в банке.
+	std::atomic<uint32_t> mEpoch{0};	 ///< Текущая эпоха.
+	std::atomic<uint8_t> mAcks[2];		 ///< Количество подтверждений эпохи банка.
+	std::atomic<uint32_t> mFailed{0};	 ///< Количество неудачных выделений памяти.
+	std::atomic<uint32_t> mAllocated{0}; ///< Количество выделений памяти.
+	uint32_t mPeak = 0;					 ///< Максимальное заполнение банка.
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size Размер одного банка памяти.
+	  \param[in] consumers Количество потребителей, подтверждающих эпоху.
+	  \param[in] caps Тип памяти heap_caps_malloc.
+	*/
+	CMsgArena(uint32_t size, uint8_t consumers, uint32_t caps = MALLOC_CAP_DEFAULT);
+	/// Деструктор.
+	virtual ~CMsgArena();
+
+	/// Выделить память в текущей эпохе.
+	/*!
+	  \param[in] size Размер памяти.
+	  \return Указатель на память или nullptr, если банк заполнен.
+	*/
+	virtual void *allocate(size_t size) override;
+	/// Освободить память (память возвращается только сбросом банка).
+	/*!
+	  \param[in] ptr Указатель на память.
+	*/
+	virtual void release(void *ptr) override{};
+	/// Проверка принадлежности памяти распределителю.
+	/*!
+	  \param[in] ptr Указатель на память.
+	  \return true, если память выделена этим распределителем.
+	*/
+	virtual bool owns(const void *ptr) override
+	{
+		return ((const uint8_t *)ptr >= mBuffer) && ((const uint8_t *)ptr < &mBuffer[2 * mSize]);
+	};
+
+	/// Перейти к следующей эпохе.
+	/*!
+	  Вызывается одной управляющей задачей.
+	  \return false, если банк следующей эпохи еще не подтвержден всеми потребителями.
+	*/
+	bool nextEpoch();
+	/// Подтвердить обработку эпохи потребителем.
+	/*!
+	  Каждый потребитель подтверждает каждую эпоху один раз.
+	  \param[in] epoch Эпоха.
+	*/
+	void ack(uint32_t epoch);
+
+	/// Текущая эпоха.
+	/*!
+	  \return Номер эпохи.
+	*/
+	inline uint32_t getEpoch() { return mEpoch.load(std::memory_order_acquire); };
+	/// Заполнение текущего банка.
+	/*!
+	  \return Размер выделенной памяти.
+	*/
+	inline uint32_t getUsed() { return mState.load(std::memory_order_relaxed) & 0x7fffffff; };
+	/// Максимальное заполнение банка.
+	/*!
+	  \return Размер памяти.
+	*/
+	inline uint32_t getPeak() { return mPeak; };
+	/// Количество выделений памяти.
+	/*!
+	  \return Количество выделений.
+	*/
+	inline uint32_t getAllocated() { return mAllocated.load(std::memory_order_relaxed); };
+	/// Количество неудачных выделений памяти.
+	/*!
+	  \return Количество неудач.
+	*/
+	inline uint32_t getFailed() { return mFailed.load(std::memory_order_relaxed); };
+};
+
+#endif // CMSGARENA_H
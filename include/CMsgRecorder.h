@@ -0,0 +1,133 @@
+/*!
+	\file
+	\brief Запись и воспроизведение потока сообщений задачи CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+
+	Требует CONFIG_TASK_RECORDER.
+*/
+
+#if !defined CMSGRECORDER_H
+#define CMSGRECORDER_H
+
+#include "sdkconfig.h"
+#include <cstdio>
+#include <atomic>
+#include "CBaseTask.h"
+#include "CLock.h"
+
+#ifdef CONFIG_TASK_RECORDER
+
+#define MSGRECORDER_MAGIC 0x5247534d ///< Сигнатура файла записи ("MSGR").
+#define MSGRECORDER_VERSION 1		 ///< Версия формата файла записи.
+
+/// Заголовок файла записи.
+struct SMsgRecordHeader
+{
+	uint32_t magic;	  ///< Сигнатура MSGRECORDER_MAGIC.
+	uint16_t version; ///< Версия формата.
+	uint16_t reserved;
+	uint32_t count; ///< Количество сообщений.
+};
+
+/// Запись сообщения в файле. За ней следует тело сообщения размером bodySize.
+struct SMsgRecord
+{
+	uint32_t delta;		 ///< Время от предыдущего сообщения (мкс).
+	uint16_t msgID;		 ///< Тип сообщения.
+	uint16_t shortParam; ///< Параметр команды.
+	uint32_t paramID;	 ///< Параметр сообщения (для сообщений без тела).
+	uint16_t bodySize;	 ///< Размер тела сообщения.
+	uint16_t reserved;
+};
+
+/// Статистика воспроизведения.
+struct SReplayStats
+{
+	uint32_t messages; ///< Количество обработанных сообщений.
+	uint32_t bytes;	   ///< Суммарный размер тел сообщений.
+	int64_t time;	   ///< Время воспроизведения (мкс).
+	int64_t busy;	   ///< Время обработки сообщений задачей (мкс), без последнего сообщения.
+};
+
+/// Размер тела сообщения для записи.
+/*!
+  \param[in] msg Сообщение.
+  \return Размер тела msgBody, 0 если тела нет.
+*/
+typedef uint16_t (*msg_body_cb_t)(const STaskMessage *msg);
+
+/// Запись и воспроизведение сообщений, принятых задачей.
+/*!
+  Подключается к задаче через CBaseTask::setRecorder().
+  Запись сохраняет каждое принятое задачей сообщение с временем и телом в двоичный файл.
+  Воспроизведение отправляет сообщения из файла в задачу того же класса, максимально быстро или с исходными интервалами,
+  и замеряет время обработки: от приема сообщения до следующего ожидания задачи в getMessage() или waitAny().
+  Воспроизведение заканчивается при приеме задачей последнего сообщения, время его обработки не учитывается.
+*/
+class CMsgRecorder : public CLock
+{
+protected:
+	FILE *mFile = nullptr;			///< Файл записи.
+	msg_body_cb_t mBodyCb = nullptr; ///< Функция размера тела сообщения.
+	uint32_t mCount = 0;			///< Количество записанных сообщений.
+	int64_t mLastTime = 0;			///< Время предыдущего записанного сообщения (мкс).
+
+	SemaphoreHandle_t mDone = nullptr;		///< Семафор окончания обработки воспроизведенных сообщений.
+	std::atomic<uint32_t> mTotal{0};		///< Количество воспроизводимых сообщений. Если 0, то воспроизведение не идет.
+	std::atomic<uint32_t> mProcessed{0};	///< Количество принятых задачей воспроизведенных сообщений.
+	int64_t mBusySince = 0;					///< Время начала обработки (мкс). Если 0, то задача ждет сообщений.
+	int64_t mEnd = 0;						///< Время приема последнего сообщения (мкс).
+	SReplayStats mStats = {};				///< Статистика последнего воспроизведения.
+
+public:
+	/// Конструктор.
+	CMsgRecorder();
+	/// Деструктор.
+	virtual ~CMsgRecorder();
+
+	/// Начать запись.
+	/*!
+	  \param[in] fileName Имя файла.
+	  \param[in] cb Функция размера тела сообщения. Если nullptr, то тела не записываются.
+	  \return true в случае успеха.
+	*/
+	bool startRecord(const char *fileName, msg_body_cb_t cb = nullptr);
+	/// Закончить запись.
+	/*!
+	  \return Количество записанных сообщений.
+	*/
+	uint32_t stopRecord();
+
+	/// Воспроизвести запись.
+	/*!
+	  Сообщения с телом отправляются в куче (CBaseTask::allocNewMsg), задача освобождает их как обычно.
+	  \param[in] fileName Имя файла.
+	  \param[in] task Задача, принимающая сообщения.
+	  \param[in] realtime Выдерживать исходные интервалы между сообщениями.
+	  \param[in] xTicksToWait Время ожидания окончания обработки в тиках.
+	  \return true, если все сообщения обработаны.
+	*/
+	bool replay(const char *fileName, CBaseTask *task, bool realtime = false, TickType_t xTicksToWait = portMAX_DELAY);
+
+	/// Сообщение принято задачей (вызывается из CBaseTask::getMessage()).
+	/*!
+	  \param[in] msg Сообщение.
+	*/
+	void received(const STaskMessage *msg);
+	/// Задача начинает ожидание сообщений (вызывается из CBaseTask).
+	void idle();
+
+	/// Получить статистику последнего воспроизведения.
+	/*!
+	  \param[out] stats Статистика.
+	*/
+	inline void getStats(SReplayStats *stats) { *stats = mStats; };
+	/// Вывести статистику последнего воспроизведения.
+	void printStats();
+};
+
+#endif // CONFIG_TASK_RECORDER
+
+#endif // CMSGRECORDER_H
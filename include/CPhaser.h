@@ -0,0 +1,158 @@
+/*!
+	\file
+	\brief Синхронизация фаз параллельной обработки в нескольких задачах.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined CPHASER_H
+#define CPHASER_H
+
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+
+#define PHASER_MAX_PARTIES (0xffff) ///< Максимальное количество участников CPhaser.
+
+/// Статистика ожидания фаз.
+struct SPhaserStats
+{
+	uint32_t phases;	///< Количество завершенных фаз.
+	uint32_t waits;		///< Количество ожиданий.
+	uint32_t spinHits;	///< Количество ожиданий, завершенных без блокировки.
+	uint32_t timeouts;	///< Количество ожиданий, завершенных по таймауту.
+	int64_t totalWait;	///< Суммарное время ожидания (мкс).
+	int64_t maxWait;	///< Максимальное время ожидания (мкс).
+	int64_t lastSkew;	///< Время от первого до последнего прибытия в последней фазе (мкс).
+	int64_t maxSkew;	///< Максимальное время от первого до последнего прибытия (мкс).
+};
+
+/// Синхронизация фаз с переменным количеством участников.
+/*!
+  Фаза завершается, когда прибыли все зарегистрированные участники.
+  Номер фазы, количество участников и количество неприбывших участников хранятся в одном атомарном слове (как в java.util.concurrent.Phaser),
+  поэтому прибытие, выход и завершение фазы - одно сравнение с обменом, которое не может сработать в другой фазе.
+  Ожидание сначала крутится на атомарном номере фазы (только на многоядерных CPU), затем блокируется на группе событий.
+  Количество участников не больше PHASER_MAX_PARTIES.
+*/
+class CPhaser
+{
+protected:
+	static constexpr int PHASE_SHIFT = 32;	 ///< Сдвиг номера фазы в слове состояния.
+	static constexpr int PARTIES_SHIFT = 16; ///< Сдвиг количества участников в слове состояния.
+	static constexpr uint64_t COUNT_MASK = 0xffff; ///< Маска количества участников и неприбывших участников.
+
+	EventGroupHandle_t mEvents = nullptr; ///< Группа событий: бит (фаза & 1) выставляется по завершении фазы.
+	SemaphoreHandle_t mSignalMutex = nullptr; ///< Мьютекс оповещения о завершении фазы.
+	std::atomic<uint64_t> mState;		  ///< Состояние: фаза, количество участников, количество неприбывших участников.
+	std::atomic<uint32_t> mPhase{0};	  ///< Номер последней объявленной фазы для активного ожидания (под mSignalMutex).
+	uint32_t mSpin;						  ///< Количество циклов ожидания до блокировки.
+
+	portMUX_TYPE mStatMux = portMUX_INITIALIZER_UNLOCKED; ///< Мьютекс статистики.
+	SPhaserStats mStats;								  ///< Статистика.
+	int64_t mFirstArrival = 0;							  ///< Время первого прибытия в фазе mFirstPhase (под mStatMux).
+	uint32_t mFirstPhase = UINT32_MAX;					  ///< Фаза, для которой записано mFirstArrival (под mStatMux).
+
+	/// Слово состояния.
+	/*!
+	  \param[in] phase Номер фазы.
+	  \param[in] parties Количество участников.
+	  \param[in] unarrived Количество неприбывших участников.
+	  eturn Слово состояния.
+	*/
+	static inline uint64_t state(uint32_t phase, uint32_t parties, uint32_t unarrived)
+	{
+		return ((uint64_t)phase << PHASE_SHIFT) | ((uint64_t)parties << PARTIES_SHIFT) | unarrived;
+	}
+
+	/// Прибытие участника.
+	/*!
+	  \param[in] deregister Флаг выхода участника.
+	  eturn Номер фазы прибытия.
+	*/
+	uint32_t doArrive(bool deregister);
+	/// Оповещение ожидающих о завершении фазы.
+	void signal();
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] parties Начальное количество участников.
+	  \param[in] spin Количество циклов ожидания до блокировки.
+	*/
+	CPhaser(uint32_t parties = 0, uint32_t spin = 1000);
+	/// Деструктор.
+	virtual ~CPhaser();
+
+	/// Зарегистрировать участника.
+	/*!
+	  Участник входит в текущую фазу.
+	  \return Номер текущей фазы.
+	*/
+	uint32_t registerParty();
+	/// Прибыть без ожидания.
+	/*!
+	  \return Номер фазы прибытия.
+	*/
+	inline uint32_t arrive() { return doArrive(false); };
+	/// Прибыть и выйти из состава участников.
+	/*!
+	  \return Номер фазы прибытия.
+	*/
+	inline uint32_t arriveAndDeregister() { return doArrive(true); };
+	/// Ожидание завершения фазы.
+	/*!
+	  \param[in] phase Номер фазы.
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если фаза завершена.
+	*/
+	bool awaitAdvance(uint32_t phase, TickType_t xTicksToWait = portMAX_DELAY);
+	/// Прибыть и ждать остальных участников.
+	/*!
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если фаза завершена.
+	*/
+	inline bool arriveAndWait(TickType_t xTicksToWait = portMAX_DELAY) { return awaitAdvance(arrive(), xTicksToWait); };
+
+	/// Номер текущей фазы.
+	/*!
+	  \return Номер фазы.
+	*/
+	inline uint32_t getPhase() { return (uint32_t)(mState.load(std::memory_order_acquire) >> PHASE_SHIFT); };
+	/// Количество участников.
+	/*!
+	  \return Количество участников.
+	*/
+	inline uint32_t getParties() { return (uint32_t)((mState.load(std::memory_order_relaxed) >> PARTIES_SHIFT) & COUNT_MASK); };
+
+	/// Получить статистику.
+	/*!
+	  \param[out] stats Статистика.
+	*/
+	void getStats(SPhaserStats *stats);
+	/// Сбросить статистику.
+	void resetStats();
+};
+
+/// Барьер для фиксированного количества задач.
+class CBarrier : public CPhaser
+{
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] parties Количество задач.
+	  \param[in] spin Количество циклов ожидания до блокировки.
+	*/
+	CBarrier(uint32_t parties, uint32_t spin = 1000) : CPhaser(parties, spin){};
+
+	/// Прибыть и ждать остальных задач.
+	/*!
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если все задачи прибыли.
+	*/
+	inline bool wait(TickType_t xTicksToWait = portMAX_DELAY) { return arriveAndWait(xTicksToWait); };
+};
+
+#endif // CPHASER_H
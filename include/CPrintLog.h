@@ -10,9 +10,10 @@
 #define CPRINTLOG_H
 
 #include "ITraceLog.h"
+#include "CLock.h"
 
 /// Класс трассировки сообщения об ошибке для консоли
-class CPrintLog : public ITraceLog
+class CPrintLog : public ITraceLog, public CLock
 {
 protected:
 	char m_header[32]; ///< Буфер для времени
@@ -26,9 +27,9 @@ protected:
 
 public:
 	/// Конструктор
-	CPrintLog() : ITraceLog(){};
+	CPrintLog();
 	/// Виртуальный деструктор
-	virtual ~CPrintLog() = default;
+	virtual ~CPrintLog();
 
 	/// Виртуальный метод трассировки
 	/*!
@@ -91,16 +92,14 @@ public:
 	*/
 	void stopTime(const char *str, uint32_t n = 1) override;
 
+	/// Обнулить метку времени
+	void startTime() override;
+
 	/// Вывести сообщение
 	/*!
 	  \param[in] str Сообщение.
 	*/
-	inline void log(const char *str) override
-	{
-		if (str != nullptr)
-			std::printf(str);
-		std::printf("\n");
-	};
+	void log(const char *str) override;
 };
 
 #endif // CPRINTLOG_H
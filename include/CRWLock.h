@@ -0,0 +1,93 @@
+/*!
+	\file
+	\brief Захват ресурса с разделяемым доступом для чтения.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined CRWLOCK_H
+#define CRWLOCK_H
+
+#include <atomic>
+#include "CLock.h"
+#include "freertos/event_groups.h"
+
+/// Разделяемый захват ресурса на время жизни объекта.
+/*!
+  \tparam L Класс ресурса с методами lockShared() и unlockShared().
+*/
+template <class L>
+class TSharedLockGuard
+{
+protected:
+	L &mLock; ///< Захваченный ресурс.
+
+public:
+	/// Конструктор с захватом ресурса.
+	/*!
+	  \param[in] lock Ресурс.
+	*/
+	explicit TSharedLockGuard(L &lock) : mLock(lock) { mLock.lockShared(); };
+	/// Деструктор с освобождением ресурса.
+	~TSharedLockGuard() { mLock.unlockShared(); };
+
+	TSharedLockGuard(const TSharedLockGuard &) = delete;
+	TSharedLockGuard &operator=(const TSharedLockGuard &) = delete;
+};
+
+/// Захват ресурса: много читателей или один писатель.
+/*!
+  Писатели захватывают мьютекс CLock и ждут выхода читателей. Пока писатель ждет или владеет ресурсом,
+  новые читатели блокируются (приоритет писателя).
+  Статистика CONFIG_LOCK_STATISTICS считается только для писателей.
+  CLock - закрытая база: захват через CLock& взял бы только мьютекс писателей без учета читателей.
+*/
+class CRWLock : protected CLock
+{
+	template <class L>
+	friend class TLockGuard;
+	template <class L>
+	friend class TSharedLockGuard;
+
+protected:
+	std::atomic<uint32_t> mState{0};	  ///< Старший бит - писатель, остальные - количество читателей.
+	EventGroupHandle_t mEvents = nullptr; ///< Группа событий: нет писателя, читатели вышли.
+
+	/// Захват ресурса писателем.
+	void lock();
+	/// Захват ресурса писателем с ограничением времени ожидания.
+	/*!
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если ресурс захвачен.
+	*/
+	bool tryLock(TickType_t xTicksToWait = 0);
+	/// Освобождение ресурса писателем.
+	void unlock();
+
+	/// Захват ресурса читателем.
+	void lockShared();
+	/// Захват ресурса читателем с ограничением времени ожидания.
+	/*!
+	  \param[in] xTicksToWait Время ожидания в тиках.
+	  \return true, если ресурс захвачен.
+	*/
+	bool tryLockShared(TickType_t xTicksToWait = 0);
+	/// Освобождение ресурса читателем.
+	void unlockShared();
+
+public:
+	/// Конструктор класса.
+	/*!
+	  \param[in] name Имя ресурса для статистики.
+	*/
+	CRWLock(const char *name = nullptr);
+	/// Деструктор.
+	~CRWLock();
+
+#ifdef CONFIG_LOCK_STATISTICS
+	using CLock::getStats;
+#endif
+};
+
+#endif // CRWLOCK_H
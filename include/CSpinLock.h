@@ -0,0 +1,56 @@
+/*!
+	\file
+	\brief Захват ресурса активным ожиданием для очень коротких критических секций.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined CSPINLOCK_H
+#define CSPINLOCK_H
+
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "CLock.h"
+
+#define SPINLOCK_MAX_HOLD 10000 ///< Максимальное время удержания по умолчанию в тактах CPU (проверяется без NDEBUG).
+
+/// Захват ресурса активным ожиданием.
+/*!
+  На время захвата запрещаются прерывания текущего ядра, поэтому задача не вытесняется,
+  а захват возможен и из прерывания. Ожидание другого ядра - test-and-test-and-set с экспоненциальной паузой.
+  Не рекурсивный. Критическая секция должна быть короче SPINLOCK_MAX_HOLD и не вызывать функции FreeRTOS, которые блокируют задачу.
+*/
+class CSpinLock
+{
+	template <class L>
+	friend class TLockGuard;
+
+protected:
+	std::atomic<uint32_t> mFlag{0}; ///< Флаг захвата.
+	UBaseType_t mIntState = 0;		///< Состояние прерываний до захвата.
+#ifndef NDEBUG
+	uint32_t mMaxHold;		   ///< Максимальное время удержания в тактах CPU.
+	uint32_t mLockCycle = 0;   ///< Такт CPU захвата.
+	int mOwnerCore = -1;	   ///< Ядро, захватившее ресурс.
+#endif
+
+	/// Захват ресурса.
+	void IRAM_ATTR lock();
+	/// Попытка захвата ресурса без ожидания.
+	/*!
+	  \return true, если ресурс захвачен.
+	*/
+	bool IRAM_ATTR tryLock();
+	/// Освобождение ресурса.
+	void IRAM_ATTR unlock();
+
+public:
+	/// Конструктор класса.
+	/*!
+	  \param[in] maxHold Максимальное время удержания в тактах CPU.
+	*/
+	CSpinLock(uint32_t maxHold = SPINLOCK_MAX_HOLD);
+};
+
+#endif // CSPINLOCK_H
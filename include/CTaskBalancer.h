@@ -0,0 +1,180 @@
+/*!
+	\file
+	\brief Балансировщик загрузки ядер CPU для задач CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+
+	Один объект на приложение.
+	Требует CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS и CONFIG_FREERTOS_USE_TRACE_FACILITY.
+*/
+
+#if !defined CTASKBALANCER_H
+#define CTASKBALANCER_H
+
+#include "sdkconfig.h"
+#include "CBaseTask.h"
+#include "CLock.h"
+#include "TFifoArray.h"
+#include <list>
+#include <vector>
+
+#ifdef CONFIG_TASK_BALANCER
+
+#define MSG_BALANCER_STOP 5200 ///< ID сообщения остановки балансировщика.
+
+#ifndef configRUN_TIME_COUNTER_TYPE
+#define configRUN_TIME_COUNTER_TYPE uint32_t ///< Тип счетчика времени выполнения в версиях FreeRTOS без настройки типа.
+#endif
+
+/// Параметры и состояние решения о переносе.
+struct SBalanceState
+{
+	uint8_t threshold;	///< Порог разницы загрузки ядер (%).
+	uint8_t hysteresis; ///< Количество периодов подряд с превышением порога до переноса.
+	uint8_t imbalance;	///< Текущее количество периодов с превышением порога.
+	uint8_t cooldown;	///< Количество периодов до следующего возможного переноса.
+};
+
+/// Загрузка задачи для решения о переносе.
+struct SBalanceLoad
+{
+	BaseType_t core; ///< Ядро задачи.
+	uint8_t load;	 ///< Загрузка CPU задачей (%).
+	bool migratable; ///< Признак разрешения переноса.
+};
+
+/// Решение балансировщика о переносе задачи.
+struct SBalanceDecision
+{
+	int64_t time;							  ///< Время принятия решения (мкс).
+	char name[configMAX_TASK_NAME_LEN];		  ///< Имя перенесенной задачи.
+	uint8_t from;							  ///< Исходное ядро.
+	uint8_t to;								  ///< Новое ядро.
+	uint8_t taskLoad;						  ///< Загрузка CPU задачей (%).
+	uint8_t coreLoad[portNUM_PROCESSORS]; ///< Загрузка ядер на момент решения (%).
+};
+
+/// Задача балансировки загрузки ядер CPU.
+/*!
+  Периодически измеряет загрузку ядер (по задачам idle) и зарегистрированных задач.
+  Если разница загрузки ядер превышает порог заданное число периодов подряд,
+  то одна из переносимых задач (CBaseTask::setMigratable) переносится на менее загруженное ядро.
+  Задачи без привязки к ядру (tskNO_AFFINITY) планировщик сам распределяет между ядрами: они входят в загрузку ядер,
+  но не переносятся, поэтому разницу загрузки, созданную ими, балансировщик не устраняет.
+*/
+class CTaskBalancer : public CBaseTask, public CLock
+{
+protected:
+	/// Данные зарегистрированной задачи.
+	struct SBalancerEntry
+	{
+		CBaseTask *task;	 ///< Задача.
+		TaskHandle_t handle; ///< Хэндлер задачи на момент прошлого замера.
+		configRUN_TIME_COUNTER_TYPE runTime; ///< Счетчик времени выполнения на момент прошлого замера.
+		uint8_t load;	  ///< Загрузка CPU задачей за прошлый период (%).
+	};
+
+	std::list<SBalancerEntry> m_list; ///< Список зарегистрированных задач.
+
+	uint32_t mPeriod = 1000;			  ///< Период замера в миллисекундах.
+	SBalanceState mState = {20, 3, 0, 0}; ///< Параметры и состояние решения о переносе.
+	std::vector<SBalanceLoad> mLoads;	  ///< Загрузка задач для решения о переносе.
+
+	TaskStatus_t *mStatus = nullptr; ///< Буфер состояния задач FreeRTOS.
+	UBaseType_t mStatusSize = 0;	 ///< Размер буфера состояния задач.
+	configRUN_TIME_COUNTER_TYPE mTotalTime = 0;						 ///< Счетчик времени на момент прошлого замера.
+	configRUN_TIME_COUNTER_TYPE mIdleTime[portNUM_PROCESSORS] = {0}; ///< Счетчики задач idle на момент прошлого замера.
+	uint8_t mCoreLoad[portNUM_PROCESSORS] = {0};  ///< Загрузка ядер за прошлый период (%).
+
+	TFifoArray<SBalanceDecision, 16> mDecisions; ///< Журнал решений.
+	uint32_t mDecisionCount = 0;			 ///< Общее количество решений.
+
+	/// Функция задачи.
+	virtual void run() override;
+
+	/// Замер загрузки.
+	/*!
+	  \return true, если замер корректен.
+	*/
+	bool sample();
+	/// Анализ загрузки и перенос задачи.
+	void balance();
+
+	/// Конструктор.
+	CTaskBalancer();
+	/// Деструктор.
+	virtual ~CTaskBalancer();
+
+public:
+	/// Загрузка за период.
+	/*!
+	  \param[in] time Время выполнения за период.
+	  \param[in] total Длительность периода, больше 0.
+	  \return Загрузка (%), не больше 100.
+	*/
+	static inline uint8_t percent(configRUN_TIME_COUNTER_TYPE time, configRUN_TIME_COUNTER_TYPE total)
+	{
+		return (time >= total) ? 100 : (uint8_t)(((uint64_t)time * 100) / total);
+	}
+
+	/// Решение о переносе по загрузке за период.
+	/*!
+	  Перенос выбирается, если разница загрузки ядер превышает порог hysteresis периодов подряд и пауза после прошлого решения истекла.
+	  Выбирается переносимая задача самого загруженного ядра, загрузка которой ближе всего к половине разницы.
+	  После решения счетчик периодов сбрасывается и начинается пауза из hysteresis периодов.
+	  \param[in,out] state Параметры и состояние.
+	  \param[in] coreLoad Загрузка ядер (%), portNUM_PROCESSORS элементов.
+	  \param[in] tasks Загрузка задач.
+	  \param[in] count Количество задач.
+	  \param[out] from Исходное ядро.
+	  \param[out] to Новое ядро.
+	  \return Индекс задачи для переноса или -1.
+	*/
+	static int decide(SBalanceState &state, const uint8_t *coreLoad, const SBalanceLoad *tasks, int count, BaseType_t &from, BaseType_t &to);
+
+	/// Единственный экземпляр класса.
+	/*!
+	  \return Указатель на CTaskBalancer
+	*/
+	static CTaskBalancer *Instance()
+	{
+		static CTaskBalancer theSingleInstance;
+		return &theSingleInstance;
+	}
+
+	/// Начальная инициализация.
+	/*!
+	  \param[in] period Период замера в миллисекундах.
+	  \param[in] threshold Порог разницы загрузки ядер (%).
+	  \param[in] hysteresis Количество периодов подряд с превышением порога до переноса.
+	  \param[in] coreID Ядро CPU (0,1).
+	*/
+	void init(uint32_t period = 1000, uint8_t threshold = 20, uint8_t hysteresis = 3, BaseType_t coreID = tskNO_AFFINITY);
+
+	/// Добавить задачу для контроля.
+	/*!
+	  Переносится только задача, созданная с привязкой к ядру.
+	  \param[in] task Задача.
+	*/
+	void add(CBaseTask *task);
+	/// Убрать задачу из контроля.
+	/*!
+	  \param[in] task Задача.
+	*/
+	void remove(CBaseTask *task);
+
+	/// Загрузка ядра CPU за прошлый период.
+	/*!
+	  \param[in] coreID Ядро CPU.
+	  \return Загрузка (%).
+	*/
+	inline uint8_t getCoreLoad(BaseType_t coreID) { return mCoreLoad[coreID]; };
+
+	/// Вывести журнал решений.
+	void printLog();
+};
+
+#endif // CONFIG_TASK_BALANCER
+
+#endif // CTASKBALANCER_H
@@ -0,0 +1,120 @@
+/*!
+	\file
+	\brief Пул задач для коротких заданий без создания и удаления задач FreeRTOS.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined CTASKPOOL_H
+#define CTASKPOOL_H
+
+#include "CBaseTask.h"
+#include "CLock.h"
+
+#define MSG_POOL_START 5220 ///< ID сообщения запуска задания в задаче пула.
+
+class CPoolTask;
+class CTaskPool;
+
+/// Функция задания.
+/*!
+  Выполняется в задаче пула. Сообщения, оставшиеся в очереди после возврата, отбрасываются.
+  \param[in] task Задача пула для приема сообщений.
+  \param[in] arg Параметр задания.
+*/
+typedef void (*pool_job_t)(CPoolTask *task, void *arg);
+
+/// Статистика пула задач.
+struct SPoolStats
+{
+	uint16_t size;	   ///< Количество задач в пуле.
+	uint16_t idle;	   ///< Количество свободных задач.
+	uint16_t peakBusy; ///< Максимальное количество занятых задач.
+	uint32_t started;  ///< Количество запущенных заданий.
+	uint32_t failed;   ///< Количество заданий, не получивших задачу.
+};
+
+/// Задача пула.
+/*!
+  Создается один раз вместе со стеком и очередью, между заданиями ждет запуска.
+*/
+class CPoolTask : public CBaseTask
+{
+	friend class CTaskPool;
+
+protected:
+	CTaskPool *mPool = nullptr; ///< Пул задачи.
+	pool_job_t mJob = nullptr;	///< Текущее задание.
+	void *mArg = nullptr;		///< Параметр текущего задания.
+
+	/// Функция задачи.
+	virtual void run() override;
+
+public:
+	using CBaseTask::getMessage;
+	using CBaseTask::waitAny;
+	using CBaseTask::setSpinReceive;
+
+	/// Установить флаг очереди сообщений для Notify на время задания.
+	/*!
+	  \param[in] notify Флаг. Если 0, то не используется.
+	*/
+	inline void setNotify(uint32_t notify) { mNotify = notify; };
+};
+
+/// Пул задач.
+class CTaskPool : public CLock
+{
+	friend class CPoolTask;
+
+protected:
+	CPoolTask *mTasks = nullptr;		   ///< Задачи пула.
+	CPoolTask **mIdle = nullptr;		   ///< Стек свободных задач.
+	SemaphoreHandle_t mAvailable = nullptr; ///< Счетный семафор свободных задач.
+	SPoolStats mStats = {};				   ///< Статистика.
+
+	/// Вернуть задачу в пул после задания.
+	/*!
+	  \param[in] task Задача.
+	*/
+	void release(CPoolTask *task);
+
+public:
+	/// Конструктор.
+	CTaskPool();
+	/// Деструктор.
+	/*!
+	  Все задания должны быть завершены.
+	*/
+	virtual ~CTaskPool();
+
+	/// Начальная инициализация.
+	/*!
+	  \param[in] name Префикс имени задач, к нему добавляется номер задачи.
+	  \param[in] size Количество задач.
+	  \param[in] usStack Размер стека.
+	  \param[in] uxPriority Приоритет.
+	  \param[in] queueLength Максимальная длина очереди сообщений.
+	  \param[in] coreID Ядро CPU (0,1).
+	*/
+	void init(const char *name, uint16_t size, unsigned short usStack, UBaseType_t uxPriority, UBaseType_t queueLength,
+			  BaseType_t coreID = tskNO_AFFINITY);
+
+	/// Запустить задание в свободной задаче пула.
+	/*!
+	  \param[in] job Функция задания.
+	  \param[in] arg Параметр задания.
+	  \param[in] xTicksToWait Время ожидания свободной задачи в тиках.
+	  \return Задача, выполняющая задание, или nullptr, если свободной задачи нет.
+	*/
+	CPoolTask *start(pool_job_t job, void *arg = nullptr, TickType_t xTicksToWait = 0);
+
+	/// Получить статистику.
+	/*!
+	  \param[out] stats Статистика.
+	*/
+	void getStats(SPoolStats *stats);
+};
+
+#endif // CTASKPOOL_H
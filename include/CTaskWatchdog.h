@@ -0,0 +1,120 @@
+/*!
+	\file
+	\brief Контроль времени обслуживания очередей задач CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+
+	Один объект на приложение.
+	Контролируемые задачи только ставят метки времени при отправке и приеме сообщений.
+*/
+
+#if !defined CTASKWATCHDOG_H
+#define CTASKWATCHDOG_H
+
+#include "sdkconfig.h"
+#include "CBaseTask.h"
+#include "CLock.h"
+#include <list>
+
+#ifdef CONFIG_TASK_WATCHDOG
+
+#define MSG_WATCHDOG_STOP 5210 ///< ID сообщения остановки контроля.
+
+/// Состояние контролируемой задачи.
+struct SWatchdogState
+{
+	CBaseTask *task;	   ///< Задача.
+	int64_t drainAge;	   ///< Время с последнего опустошения очереди (мкс), 0 если очередь пуста.
+	int64_t pendingAge;	   ///< Возраст самого старого сообщения в очереди (оценка сверху, мкс).
+	UBaseType_t queued;	   ///< Количество сообщений в очереди.
+	eTaskState state;	   ///< Состояние задачи FreeRTOS.
+	UBaseType_t stackFree; ///< Минимальный свободный стек задачи.
+};
+
+/// Функция обратного вызова при нарушении ограничения.
+/*!
+  \param[in] state Состояние задачи.
+  \param[in] arg Параметр, переданный при регистрации.
+*/
+typedef void (*watchdog_cb_t)(const SWatchdogState *state, void *arg);
+
+/// Задача контроля времени обслуживания очередей.
+class CTaskWatchdog : public CBaseTask, public CLock
+{
+protected:
+	/// Данные контролируемой задачи.
+	struct SWatchdogEntry
+	{
+		CBaseTask *task;	   ///< Задача.
+		int64_t drainLimit;	   ///< Ограничение времени с последнего опустошения очереди (мкс).
+		int64_t pendingLimit;  ///< Ограничение возраста сообщения в очереди (мкс).
+		watchdog_cb_t cb;	   ///< Функция обратного вызова.
+		void *arg;			   ///< Параметр функции обратного вызова.
+		bool fired;			   ///< Флаг сработавшего ограничения.
+	};
+
+	std::list<SWatchdogEntry> m_list; ///< Список контролируемых задач.
+	uint32_t mPeriod = 100;			  ///< Период проверки в миллисекундах.
+	uint32_t mViolations = 0;		  ///< Общее количество нарушений.
+
+	/// Функция задачи.
+	virtual void run() override;
+	/// Проверка всех задач.
+	void check();
+
+	/// Конструктор.
+	CTaskWatchdog();
+	/// Деструктор.
+	virtual ~CTaskWatchdog();
+
+public:
+	/// Единственный экземпляр класса.
+	/*!
+	  \return Указатель на CTaskWatchdog
+	*/
+	static CTaskWatchdog *Instance()
+	{
+		static CTaskWatchdog theSingleInstance;
+		return &theSingleInstance;
+	}
+
+	/// Начальная инициализация.
+	/*!
+	  \param[in] period Период проверки в миллисекундах.
+	  \param[in] coreID Ядро CPU (0,1).
+	*/
+	void init(uint32_t period = 100, BaseType_t coreID = tskNO_AFFINITY);
+
+	/// Добавить задачу для контроля.
+	/*!
+	  \param[in] task Задача.
+	  \param[in] drainLimit Ограничение времени с последнего опустошения очереди (мкс). Если 0, то не контролируется.
+	  \param[in] pendingLimit Ограничение возраста сообщения в очереди (мкс). Если 0, то не контролируется.
+	  \param[in] cb Функция обратного вызова.
+	  \param[in] arg Параметр функции обратного вызова.
+	*/
+	void add(CBaseTask *task, int64_t drainLimit, int64_t pendingLimit, watchdog_cb_t cb = nullptr, void *arg = nullptr);
+	/// Убрать задачу из контроля.
+	/*!
+	  \param[in] task Задача.
+	*/
+	void remove(CBaseTask *task);
+
+	/// Получить состояние задачи.
+	/*!
+	  \param[in] task Задача.
+	  \param[out] state Состояние задачи.
+	*/
+	static void getState(CBaseTask *task, SWatchdogState *state);
+
+	/// Общее количество нарушений.
+	/*!
+	  \return Количество нарушений.
+	*/
+	inline uint32_t getViolations() { return mViolations; };
+};
+
+#endif // CONFIG_TASK_WATCHDOG
+
+#endif // CTASKWATCHDOG_H
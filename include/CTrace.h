@@ -13,7 +13,7 @@
 #include <stdint.h>
 #include "ITraceLog.h"
 #include "CLock.h"
-#include <list>
+#include <atomic>
 #include "esp_log.h"
 
 #ifdef CONFIG_COMPILER_CXX_RTTI
@@ -204,10 +204,58 @@
 #endif
 
 /// Класс списка зарегистрированных трассировщиков
+/*!
+  Трассировщики хранятся в неизменяемом массиве, оканчивающемся nullptr.
+  add() и remove() создают новый массив, атомарно подменяют его и освобождают старый после выхода всех читателей.
+  Читатели считаются в двух поколениях: после подмены новые читатели идут в новое поколение,
+  а писатель ждет только читателей старого, поэтому непрерывный вывод из многих задач его не задерживает.
+  Вывод из задач и прерываний идет без блокировки. Трассировщик не может вызывать add(), remove() и clear() из trace().
+*/
 class CTraceList : public ITraceLog, public CLock
 {
 protected:
-	std::list<ITraceLog *> m_list; ///< Список зарегестрированных трассировщиков
+	std::atomic<ITraceLog **> mSinks;		 ///< Массив зарегистрированных трассировщиков
+	std::atomic<uint32_t> mGeneration{0};	 ///< Текущее поколение читателей (0 или 1)
+	std::atomic<uint32_t> mReaders[2] = {}; ///< Количество читателей массива по поколениям
+
+	static ITraceLog *mEmpty[1];			 ///< Пустой массив
+	static thread_local uint32_t mDepth; ///< Вложенность чтения массива в текущей задаче
+
+	/// Начало чтения массива
+	/*!
+	  \param[out] gen Поколение читателя для leave().
+	  \return Массив трассировщиков.
+	*/
+	inline ITraceLog **enter(uint32_t &gen)
+	{
+		for (;;)
+		{
+			gen = mGeneration.load(std::memory_order_seq_cst);
+			mReaders[gen].fetch_add(1, std::memory_order_seq_cst);
+			// Если поколение сменилось, писатель мог не увидеть этого читателя.
+			if (mGeneration.load(std::memory_order_seq_cst) == gen)
+				break;
+			mReaders[gen].fetch_sub(1, std::memory_order_release);
+		}
+		mDepth++;
+		return mSinks.load(std::memory_order_seq_cst);
+	};
+	/// Конец чтения массива
+	/*!
+	  \param[in] gen Поколение читателя из enter().
+	*/
+	inline void leave(uint32_t gen)
+	{
+		mDepth--;
+		mReaders[gen].fetch_sub(1, std::memory_order_release);
+	};
+	/// Подменить массив и дождаться выхода читателей старого массива
+	/*!
+	  Вызывается при захваченном ресурсе.
+	  \param[in] sinks Новый массив.
+	  \return Старый массив.
+	*/
+	ITraceLog **replace(ITraceLog **sinks);
 
 public:
 	/// Конструктор
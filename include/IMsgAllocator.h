@@ -0,0 +1,60 @@
+/*!
+	\file
+	\brief Интерфейс распределителя памяти для тел сообщений STaskMessage.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined IMSGALLOCATOR_H
+#define IMSGALLOCATOR_H
+
+#include <cstddef>
+#include "freertos/FreeRTOS.h"
+
+/// Интерфейс распределителя памяти для тел сообщений.
+/*!
+  Все созданные распределители регистрируются в общем списке,
+  чтобы CBaseTask::freeMsg() мог вернуть память тому, кто ее выделил.
+*/
+class IMsgAllocator
+{
+protected:
+	IMsgAllocator *mNext = nullptr; ///< Следующий распределитель в списке.
+
+	static IMsgAllocator *mFirst; ///< Первый распределитель в списке.
+	static portMUX_TYPE mListMux; ///< Мьютекс списка распределителей.
+
+public:
+	/// Конструктор.
+	IMsgAllocator();
+	/// Виртуальный деструктор.
+	virtual ~IMsgAllocator();
+
+	/// Выделить память.
+	/*!
+	  \param[in] size Размер памяти.
+	  \return Указатель на память или nullptr.
+	*/
+	virtual void *allocate(size_t size) = 0;
+	/// Освободить память.
+	/*!
+	  \param[in] ptr Указатель на память.
+	*/
+	virtual void release(void *ptr) = 0;
+	/// Проверка принадлежности памяти распределителю.
+	/*!
+	  \param[in] ptr Указатель на память.
+	  \return true, если память выделена этим распределителем.
+	*/
+	virtual bool owns(const void *ptr) = 0;
+
+	/// Найти распределитель, выделивший память.
+	/*!
+	  \param[in] ptr Указатель на память.
+	  \return Распределитель или nullptr, если память выделена из кучи.
+	*/
+	static IMsgAllocator *find(const void *ptr);
+};
+
+#endif // IMSGALLOCATOR_H
@@ -0,0 +1,58 @@
+/*!
+	\file
+	\brief Политики выделения памяти FIFO буферов через heap_caps.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TFIFOALLOCATORS_H
+#define TFIFOALLOCATORS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "esp_heap_caps.h"
+
+template <uint32_t CAPS, size_t ALIGN = 0>
+/// Выделение памяти FIFO буфера через heap_caps_aligned_alloc.
+/*!
+  Элементы не конструируются, поэтому тип элемента должен быть тривиальным.
+  \tparam CAPS тип памяти (MALLOC_CAP_*).
+  \tparam ALIGN выравнивание, степень 2. Если 0, то выравнивание типа элемента.
+*/
+struct THeapCapsAllocator
+{
+	/// Выделить память.
+	/*!
+	  \param[in] size количество элементов.
+	  \return память.
+	*/
+	template <typename T>
+	static T *allocate(int size)
+	{
+		static_assert(std::is_trivial_v<T>, "heap_caps FIFO element must be trivial");
+		constexpr size_t align = (ALIGN > alignof(T)) ? ALIGN : alignof(T);
+		return (T *)heap_caps_aligned_alloc(align, sizeof(T) * size, CAPS);
+	}
+
+	/// Освободить память.
+	/*!
+	  \param[in] p память или nullptr.
+	*/
+	template <typename T>
+	static void deallocate(T *p)
+	{
+		if (p != nullptr)
+			heap_caps_free(p);
+	}
+};
+
+/// Внутренняя SRAM для небольших буферов с частым доступом.
+using TInternalAllocator = THeapCapsAllocator<MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT>;
+/// Память, доступная DMA, с выравниванием на 4 байта.
+using TDmaAllocator = THeapCapsAllocator<MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, 4>;
+/// Внешняя PSRAM для больших буферов.
+using TPsramAllocator = THeapCapsAllocator<MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT>;
+
+#endif // TFIFOALLOCATORS_H
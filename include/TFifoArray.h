@@ -9,45 +9,234 @@
 #if !defined TFIFOARRAY_H
 #define TFIFOARRAY_H
 
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <cassert>
+#include <algorithm>
+// Двойное отображение памяти TMirrorFifoArray доступно при сборке под хост (target linux), sdkconfig для этого не нужен.
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 template <typename T>
-/// Шаблон для циклического FIFO буфера.
-class TFifoArray
+/// Два непрерывных участка FIFO буфера, первым идет более старый.
+struct TFifoSpans
+{
+	T *first;		///< первый участок.
+	int firstSize;	///< размер первого участка.
+	T *second;		///< второй участок.
+	int secondSize; ///< размер второго участка (0, если данные не переходят через конец буфера).
+};
+
+/// Выделение памяти FIFO буфера через new[].
+struct TNewAllocator
+{
+	/// Выделить память.
+	/*!
+	  \param[in] size количество элементов.
+	  \return память.
+	*/
+	template <typename T>
+	static T *allocate(int size) { return new T[size]; }
+
+	/// Освободить память.
+	/*!
+	  \param[in] p память или nullptr.
+	*/
+	template <typename T>
+	static void deallocate(T *p) { delete[] p; }
+};
+
+template <typename T, int N, typename Alloc = TNewAllocator>
+/// Память FIFO буфера размером N, заданным при компиляции.
+/*!
+  Память внутри объекта, Alloc не используется.
+*/
+class TFifoStorage
+{
+	static_assert(N > 0, "FIFO size must be positive");
+
+protected:
+	T mBuffer[N];				   ///< буфер.
+	static constexpr int mSize = N; ///< размер.
+
+	/// Конструктор.
+	/*!
+	  \param[in] size размер, должен совпадать с N.
+	*/
+	TFifoStorage(int size = N)
+	{
+		assert(size == N);
+	}
+
+	/// Индекс в буфере.
+	/*!
+	  Для N, равного степени 2, вычисляется маской.
+	  \param[in] index индекс, может быть отрицательным или больше размера.
+	  \return индекс от 0 до N-1.
+	*/
+	static constexpr int wrap(int index)
+	{
+		if constexpr ((N & (N - 1)) == 0)
+		{
+			return index & (N - 1);
+		}
+		else
+		{
+			int i = index % N;
+			return (i < 0) ? (i + N) : i;
+		}
+	}
+};
+
+template <typename T, typename Alloc>
+/// Память FIFO буфера в куче, размер задается при создании.
+/*!
+  Объект можно перемещать, но не копировать. После перемещения исходный объект можно только удалить или присвоить.
+*/
+class TFifoStorage<T, 0, Alloc>
 {
 protected:
 	T *mBuffer; ///< буфер.
 	int mSize;	///< размер.
-	int mIndex; ///< текущий индекс.
-public:
+
 	/// Конструктор.
 	/*!
 	  \param[in] size размер.
 	*/
-	TFifoArray(int size) : mSize(size), mIndex(0)
+	TFifoStorage(int size) : mSize(size)
+	{
+		assert(size > 0);
+		mBuffer = Alloc::template allocate<T>(mSize);
+		// Как и new[], нехватка памяти (например, PSRAM) останавливает программу, а не откладывает ошибку до первого push().
+		if (mBuffer == nullptr)
+			std::abort();
+	}
+
+	/// Конструктор перемещения.
+	/*!
+	  \param[in,out] other исходный объект.
+	*/
+	TFifoStorage(TFifoStorage &&other) noexcept : mBuffer(other.mBuffer), mSize(other.mSize)
+	{
+		other.mBuffer = nullptr;
+		other.mSize = 0;
+	}
+
+	/// Присваивание перемещением.
+	/*!
+	  \param[in,out] other исходный объект.
+	  \return объект.
+	*/
+	TFifoStorage &operator=(TFifoStorage &&other) noexcept
 	{
-		mBuffer = new T[mSize];
+		if (this != &other)
+		{
+			Alloc::deallocate(mBuffer);
+			mBuffer = other.mBuffer;
+			mSize = other.mSize;
+			other.mBuffer = nullptr;
+			other.mSize = 0;
+		}
+		return *this;
 	}
 
+	TFifoStorage(const TFifoStorage &) = delete;
+	TFifoStorage &operator=(const TFifoStorage &) = delete;
+
 	/// Деструктор.
-	~TFifoArray()
+	~TFifoStorage()
+	{
+		Alloc::deallocate(mBuffer);
+	}
+
+	/// Индекс в буфере.
+	/*!
+	  \param[in] index индекс, может быть отрицательным или больше размера.
+	  \return индекс от 0 до mSize-1.
+	*/
+	inline int wrap(int index) const
+	{
+		int i = index % mSize;
+		return (i < 0) ? (i + mSize) : i;
+	}
+};
+
+template <typename T, int N = 0, typename Alloc = TNewAllocator>
+/// Шаблон для циклического FIFO буфера.
+/*!
+  \tparam T тип элемента.
+  \tparam N размер, если 0, то размер задается в конструкторе и память выделяется в куче.
+  \tparam Alloc выделение памяти для N = 0: TNewAllocator или политики из TFifoAllocators.h (TInternalAllocator, TDmaAllocator, TPsramAllocator, THeapCapsAllocator).
+  Для N > 0 память внутри объекта, а для N, равного степени 2, индексы вычисляются маской.
+*/
+class TFifoArray : public TFifoStorage<T, N, Alloc>
+{
+protected:
+	using TFifoStorage<T, N, Alloc>::mBuffer;
+	using TFifoStorage<T, N, Alloc>::mSize;
+	using TFifoStorage<T, N, Alloc>::wrap;
+
+	int mIndex;		///< текущий индекс.
+	int mUnread = 0; ///< количество элементов, не извлеченных pop().
+
+	/// Получить элементы в виде двух непрерывных участков без перемещения данных.
+	/*!
+	  \param[in] offset индекс первого элемента, может быть отрицательным.
+	  \param[in] count количество элементов, не больше размера буфера.
+	  \return участки, первым идет более старый.
+	*/
+	TFifoSpans<T> range(int offset, int count)
+	{
+		assert((count >= 0) && (count <= mSize));
+		int start = wrap(mIndex + offset);
+		int n = mSize - start;
+		if (count <= n)
+			return {&mBuffer[start], count, mBuffer, 0};
+		return {&mBuffer[start], n, mBuffer, count - n};
+	}
+
+	/// Скопировать участок с шагом.
+	/*!
+	  \param[out] dst буфер.
+	  \param[in] src участок.
+	  \param[in] count количество элементов.
+	  \param[in] stride шаг в буфере.
+	*/
+	static inline void copy(T *dst, const T *src, int count, int stride)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			*dst = src[i];
+			dst += stride;
+		}
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. Для N > 0 можно не указывать.
+	*/
+	TFifoArray(int size = N) : TFifoStorage<T, N, Alloc>(size), mIndex(0)
 	{
-		delete mBuffer;
 	}
 
 	/// Получить размер буфера.
 	/*!
 	  \return размер.
 	*/
-	inline int getSize() { return mSize; };
+	constexpr int getSize() const { return mSize; };
 
 	/// Внести данные в FIFO.
 	/*!
 	  \param[in] data данные.
 	  \param[in] size размер данных.
 	*/
-	void push(T *data, int size)
+	void push(const T *data, int size)
 	{
+		mUnread = std::min(mUnread + size, mSize);
 		if (size >= mSize)
 		{
 			std::memcpy(mBuffer, &data[size - mSize], sizeof(T) * mSize);
@@ -81,6 +270,8 @@ public:
 	*/
 	void push(T value)
 	{
+		if (mUnread < mSize)
+			mUnread++;
 		mBuffer[mIndex] = value;
 		if (mIndex == (mSize - 1))
 			mIndex = 0;
@@ -93,30 +284,39 @@ public:
 	  \param[in] index индекс, может быть отрицательным.
 	  \return элемент.
 	*/
-	T &operator[](int index)
+	inline T &operator[](int index)
 	{
-		int i = (mIndex + index) % mSize;
-		if (i < 0)
-			i += mSize;
-		return mBuffer[i];
+		return mBuffer[wrap(mIndex + index)];
 	}
 
 	/// Выравнивание по 0 индексу.
+	/*!
+	  Поворот на месте без выделения памяти.
+	  \return буфер, начиная с самого старого элемента.
+	*/
 	T *align()
 	{
 		if (mIndex != 0)
 		{
-			int n = mSize - mIndex;
-			T *data = new T[mIndex];
-			std::memcpy(data, mBuffer, sizeof(T) * mIndex);
-			std::memmove(mBuffer, &mBuffer[mIndex], sizeof(T) * n);
-			std::memcpy(&mBuffer[n], data, sizeof(T) * mIndex);
-			delete[] data;
+			std::rotate(mBuffer, &mBuffer[mIndex], &mBuffer[mSize]);
 			mIndex = 0;
 		}
 		return mBuffer;
 	}
 
+	/// Получить последние элементы в виде двух непрерывных участков без перемещения данных.
+	/*!
+	  \param[in] count количество последних элементов, не больше размера буфера.
+	  \return участки, первым идет более старый.
+	*/
+	inline TFifoSpans<T> spans(int count) { return range(-count, count); }
+
+	/// Получить весь буфер в виде двух непрерывных участков без перемещения данных.
+	/*!
+	  \return участки, первым идет более старый.
+	*/
+	inline TFifoSpans<T> spans() { return spans(mSize); }
+
 	/// Получить указатель на элемент по индексу.
 	/*!
 	  \param[in] index индекс, может быть отрицательным.
@@ -133,6 +333,286 @@ public:
 	{
 		std::memset(mBuffer, 0, sizeof(T) * mSize);
 		mIndex = 0;
+		mUnread = 0;
+	}
+
+	/// Скопировать элементы из FIFO.
+	/*!
+	  Не более двух memcpy.
+	  \param[out] dst буфер.
+	  \param[in] count количество элементов, не больше размера буфера.
+	  \param[in] offset индекс первого элемента как в operator[], может быть отрицательным.
+	*/
+	void read(T *dst, int count, int offset)
+	{
+		TFifoSpans<T> s = range(offset, count);
+		std::memcpy(dst, s.first, sizeof(T) * s.firstSize);
+		if (s.secondSize != 0)
+			std::memcpy(&dst[s.firstSize], s.second, sizeof(T) * s.secondSize);
+	}
+	/// Скопировать последние элементы из FIFO.
+	/*!
+	  \param[out] dst буфер.
+	  \param[in] count количество элементов, не больше размера буфера.
+	*/
+	inline void read(T *dst, int count) { read(dst, count, -count); }
+
+	/// Скопировать элементы из FIFO в буфер с шагом.
+	/*!
+	  Например, в один канал буфера с чередованием каналов.
+	  \param[out] dst буфер.
+	  \param[in] count количество элементов, не больше размера буфера.
+	  \param[in] offset индекс первого элемента как в operator[].
+	  \param[in] stride шаг в буфере dst.
+	*/
+	void read(T *dst, int count, int offset, int stride)
+	{
+		TFifoSpans<T> s = range(offset, count);
+		copy(dst, s.first, s.firstSize, stride);
+		copy(&dst[s.firstSize * stride], s.second, s.secondSize, stride);
+	}
+
+	template <int M, typename B>
+	/// Скопировать элементы из FIFO в другой FIFO.
+	/*!
+	  Не более четырех memcpy.
+	  \param[out] dst FIFO.
+	  \param[in] count количество элементов, не больше размера буфера.
+	  \param[in] offset индекс первого элемента как в operator[].
+	*/
+	void read(TFifoArray<T, M, B> &dst, int count, int offset)
+	{
+		TFifoSpans<T> s = range(offset, count);
+		dst.push(s.first, s.firstSize);
+		if (s.secondSize != 0)
+			dst.push(s.second, s.secondSize);
+	}
+
+	/// Количество элементов, не извлеченных pop().
+	/*!
+	  Растет при push() до размера буфера, старые элементы перезаписываются.
+	  \return количество.
+	*/
+	inline int getUnread() const { return mUnread; };
+
+	/// Извлечь самые старые непрочитанные элементы.
+	/*!
+	  \param[out] dst буфер.
+	  \param[in] count размер буфера.
+	  \return количество извлеченных элементов.
+	*/
+	int pop(T *dst, int count)
+	{
+		count = std::min(count, mUnread);
+		read(dst, count, -mUnread);
+		mUnread -= count;
+		return count;
+	}
+
+	/// Извлечь самые старые непрочитанные элементы в буфер с шагом.
+	/*!
+	  \param[out] dst буфер.
+	  \param[in] count количество элементов в буфере.
+	  \param[in] stride шаг в буфере dst.
+	  \return количество извлеченных элементов.
+	*/
+	int pop(T *dst, int count, int stride)
+	{
+		count = std::min(count, mUnread);
+		read(dst, count, -mUnread, stride);
+		mUnread -= count;
+		return count;
+	}
+
+	template <int M, typename B>
+	/// Извлечь самые старые непрочитанные элементы в другой FIFO.
+	/*!
+	  \param[out] dst FIFO.
+	  \param[in] count максимальное количество элементов.
+	  \return количество извлеченных элементов.
+	*/
+	int pop(TFifoArray<T, M, B> &dst, int count)
+	{
+		count = std::min(count, mUnread);
+		read(dst, count, -mUnread);
+		mUnread -= count;
+		return count;
+	}
+};
+
+template <typename T>
+/// Циклический FIFO буфер с зеркальной памятью.
+/*!
+  Последние k элементов всегда лежат в памяти непрерывно, window(k) возвращает указатель на них без копирования.
+  На target linux одни и те же страницы памяти отображаются два раза подряд (memfd_create + mmap), размер округляется до страницы.
+  Иначе (нет MMU) память выделяется двойного размера и каждый элемент пишется два раза: в i и i + размер.
+  \tparam T тип элемента, копируется через memcpy.
+*/
+class TMirrorFifoArray
+{
+protected:
+	T *mBuffer = nullptr; ///< буфер двойного размера.
+	int mSize;			  ///< размер.
+	int mIndex = 0;		  ///< текущий индекс.
+	bool mMapped = false; ///< вторая половина буфера - отображение первой.
+
+	/// Записать непрерывный участок.
+	/*!
+	  \param[in] index индекс в буфере.
+	  \param[in] data данные.
+	  \param[in] size размер данных, не больше mSize - index.
+	*/
+	inline void write(int index, const T *data, int size)
+	{
+		std::memcpy(&mBuffer[index], data, sizeof(T) * size);
+		if (!mMapped)
+			std::memcpy(&mBuffer[index + mSize], data, sizeof(T) * size);
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. На target linux может быть увеличен до целого числа страниц, см. getSize().
+	*/
+	TMirrorFifoArray(int size) : mSize(size)
+	{
+		assert(size > 0);
+#ifdef __linux__
+		size_t page = (size_t)sysconf(_SC_PAGESIZE);
+		if ((page % sizeof(T)) == 0)
+		{
+			size_t bytes = ((sizeof(T) * size + page - 1) / page) * page;
+			int fd = memfd_create("fifo", 0);
+			if (fd >= 0)
+			{
+				uint8_t *p = nullptr;
+				if (ftruncate(fd, bytes) == 0)
+				{
+					void *area = mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+					if (area != MAP_FAILED)
+					{
+						p = (uint8_t *)area;
+						if ((mmap(p, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+							(mmap(&p[bytes], bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+						{
+							munmap(area, 2 * bytes);
+							p = nullptr;
+						}
+					}
+				}
+				close(fd);
+				if (p != nullptr)
+				{
+					mBuffer = (T *)p;
+					mSize = bytes / sizeof(T);
+					mMapped = true;
+					return;
+				}
+			}
+		}
+#endif
+		mBuffer = new T[2 * mSize]();
+	}
+
+	/// Деструктор.
+	~TMirrorFifoArray()
+	{
+#ifdef __linux__
+		if (mMapped)
+		{
+			munmap(mBuffer, 2 * sizeof(T) * mSize);
+			return;
+		}
+#endif
+		delete[] mBuffer;
+	}
+
+	TMirrorFifoArray(const TMirrorFifoArray &) = delete;
+	TMirrorFifoArray &operator=(const TMirrorFifoArray &) = delete;
+
+	/// Получить размер буфера.
+	/*!
+	  \return размер.
+	*/
+	inline int getSize() const { return mSize; };
+
+	/// Память отображена два раза (без двойной записи).
+	/*!
+	  \return true, если используется mmap.
+	*/
+	inline bool isMapped() const { return mMapped; };
+
+	/// Внести данные в FIFO.
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	*/
+	void push(const T *data, int size)
+	{
+		if (size >= mSize)
+		{
+			write(0, &data[size - mSize], mSize);
+			mIndex = 0;
+		}
+		else
+		{
+			int n = mSize - mIndex;
+			if (size < n)
+			{
+				write(mIndex, data, size);
+				mIndex += size;
+			}
+			else
+			{
+				write(mIndex, data, n);
+				write(0, &data[n], size - n);
+				mIndex = size - n;
+			}
+		}
+	}
+
+	/// Внести данные в FIFO.
+	/*!
+	  \param[in] value данные.
+	*/
+	void push(T value)
+	{
+		mBuffer[mIndex] = value;
+		if (!mMapped)
+			mBuffer[mIndex + mSize] = value;
+		if (mIndex == (mSize - 1))
+			mIndex = 0;
+		else
+			mIndex++;
+	}
+
+	/// Получить элемент по индексу.
+	/*!
+	  \param[in] index индекс от -размера до размера - 1, отрицательный отсчитывается от последнего элемента.
+	  \return элемент.
+	*/
+	inline T &operator[](int index)
+	{
+		assert((index >= -mSize) && (index < mSize));
+		return mBuffer[(index < 0) ? (mIndex + mSize + index) : (mIndex + index)];
+	}
+
+	/// Получить последние элементы одним непрерывным участком.
+	/*!
+	  \param[in] count количество последних элементов, не больше размера буфера.
+	  \return указатель на самый старый из них.
+	*/
+	inline const T *window(int count) const
+	{
+		assert((count >= 0) && (count <= mSize));
+		return &mBuffer[mIndex + mSize - count];
+	}
+
+	/// Очистка FIFO.
+	inline void clear()
+	{
+		std::memset(mBuffer, 0, sizeof(T) * (mMapped ? mSize : 2 * mSize));
+		mIndex = 0;
 	}
 };
 
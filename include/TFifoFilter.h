@@ -0,0 +1,382 @@
+/*!
+	\file
+	\brief Шаблоны потоковых фильтров над FIFO буфером.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TFIFOFILTER_H
+#define TFIFOFILTER_H
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "TFifoArray.h"
+
+template <typename T, typename C = float>
+/// Скалярное произведение по непрерывному участку.
+/*!
+  \param[in] x данные.
+  \param[in] c коэффициенты.
+  \param[in] size размер.
+  \return сумма x[i]*c[i].
+*/
+inline C fifoDot(const T *__restrict x, const C *__restrict c, int size)
+{
+	C s = 0;
+	for (int i = 0; i < size; i++)
+		s += (C)x[i] * c[i];
+	return s;
+}
+
+template <typename T, int TAPS, typename C = float>
+/// Потоковый КИХ (FIR) фильтр.
+/*!
+  Коэффициенты упорядочены по времени: coeffs[0] умножается на самый старый отсчет окна, coeffs[TAPS-1] - на последний
+  (для симметричных фильтров порядок не важен). Свертка считается прямо по двум участкам FIFO без align().
+  \tparam T тип отсчета.
+  \tparam TAPS количество коэффициентов.
+  \tparam C тип коэффициентов и сумм.
+*/
+class TFirFilter
+{
+protected:
+	const C *mCoeffs;				///< коэффициенты.
+	TFifoArray<T, TAPS> mHistory;	///< последние TAPS отсчетов.
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] coeffs коэффициенты, TAPS элементов. Память не копируется.
+	*/
+	TFirFilter(const C *coeffs) : mCoeffs(coeffs)
+	{
+		mHistory.clear();
+	}
+
+	/// Применить фильтр к последним TAPS отсчетам FIFO.
+	/*!
+	  \param[in] fifo FIFO размером не меньше TAPS.
+	  \param[in] coeffs коэффициенты, TAPS элементов.
+	  \return выход фильтра.
+	*/
+	template <int N, typename Alloc>
+	static C apply(TFifoArray<T, N, Alloc> &fifo, const C *coeffs)
+	{
+		TFifoSpans<T> s = fifo.spans(TAPS);
+		return fifoDot(s.first, coeffs, s.firstSize) + fifoDot(s.second, &coeffs[s.firstSize], s.secondSize);
+	}
+
+	/// Обработать отсчет.
+	/*!
+	  \param[in] x отсчет.
+	  \return выход фильтра.
+	*/
+	inline C process(T x)
+	{
+		mHistory.push(x);
+		return apply(mHistory, mCoeffs);
+	}
+
+	/// Обработать блок.
+	/*!
+	  \param[in] in входные отсчеты.
+	  \param[out] out выходные отсчеты, может совпадать с in.
+	  \param[in] count количество отсчетов.
+	*/
+	void process(const T *in, T *out, int count)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = (T)process(in[i]);
+	}
+
+	/// Обработать участки FIFO.
+	/*!
+	  \param[in] in участки, например, spans() входного FIFO.
+	  \param[out] out выходные отсчеты, in.firstSize + in.secondSize.
+	*/
+	inline void process(const TFifoSpans<T> &in, T *out)
+	{
+		process(in.first, out, in.firstSize);
+		process(in.second, &out[in.firstSize], in.secondSize);
+	}
+
+	/// Сброс состояния.
+	inline void clear() { mHistory.clear(); }
+};
+
+template <typename T, int TAPS, int M, typename C = float>
+/// Полифазный КИХ фильтр с децимацией в M раз.
+/*!
+  Коэффициенты раскладываются на M подфильтров по (TAPS + M - 1) / M коэффициентов.
+  Каждый входной отсчет попадает в историю одного подфильтра, выход - сумма сверток подфильтров раз в M отсчетов,
+  то есть TAPS умножений на выходной отсчет и без сдвига общей истории на каждом входном.
+  Выход совпадает с выходом TFirFilter на каждом M-м отсчете.
+  \tparam T тип отсчета.
+  \tparam TAPS количество коэффициентов.
+  \tparam M коэффициент децимации.
+  \tparam C тип коэффициентов и сумм.
+*/
+class TFirDecimator
+{
+	static_assert(M > 0, "decimation factor must be positive");
+
+protected:
+	static constexpr int L = (TAPS + M - 1) / M; ///< длина подфильтра.
+
+	C mCoeffs[M][L];			///< коэффициенты подфильтров, по времени от старого к новому.
+	TFifoArray<T, L> mBranch[M]; ///< истории подфильтров.
+	int mPhase = 0;				///< номер отсчета внутри периода децимации.
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] coeffs коэффициенты, TAPS элементов, копируются в подфильтры.
+	*/
+	TFirDecimator(const C *coeffs)
+	{
+		// Подфильтр b получает отсчеты, которые к моменту выхода имеют возраст b, b + M, b + 2M, ...
+		for (int b = 0; b < M; b++)
+		{
+			for (int i = 0; i < L; i++)
+			{
+				int k = TAPS - 1 - b - (L - 1 - i) * M;
+				mCoeffs[b][i] = (k >= 0) ? coeffs[k] : 0;
+			}
+		}
+		clear();
+	}
+
+	/// Обработать отсчет.
+	/*!
+	  \param[in] x отсчет.
+	  \param[out] y выход фильтра, если он получен.
+	  \return true, если получен выходной отсчет (каждый M-й входной).
+	*/
+	inline bool process(T x, C &y)
+	{
+		mBranch[M - 1 - mPhase].push(x);
+		if (++mPhase != M)
+			return false;
+		mPhase = 0;
+		y = 0;
+		for (int b = 0; b < M; b++)
+		{
+			TFifoSpans<T> s = mBranch[b].spans(L);
+			y += fifoDot(s.first, mCoeffs[b], s.firstSize) + fifoDot(s.second, &mCoeffs[b][s.firstSize], s.secondSize);
+		}
+		return true;
+	}
+
+	/// Обработать блок.
+	/*!
+	  \param[in] in входные отсчеты.
+	  \param[out] out выходные отсчеты, не более count / M + 1, может совпадать с in.
+	  \param[in] count количество отсчетов.
+	  \return количество выходных отсчетов.
+	*/
+	int process(const T *in, T *out, int count)
+	{
+		int n = 0;
+		C y;
+		for (int i = 0; i < count; i++)
+		{
+			if (process(in[i], y))
+				out[n++] = (T)y;
+		}
+		return n;
+	}
+
+	/// Обработать участки FIFO.
+	/*!
+	  \param[in] in участки, например, spans() входного FIFO.
+	  \param[out] out выходные отсчеты.
+	  \return количество выходных отсчетов.
+	*/
+	inline int process(const TFifoSpans<T> &in, T *out)
+	{
+		int n = process(in.first, out, in.firstSize);
+		return n + process(in.second, &out[n], in.secondSize);
+	}
+
+	/// Сброс состояния.
+	inline void clear()
+	{
+		for (int b = 0; b < M; b++)
+			mBranch[b].clear();
+		mPhase = 0;
+	}
+};
+
+template <typename T, const auto &COEFFS>
+/// Потоковый КИХ фильтр с коэффициентами, заданными при компиляции.
+/*!
+  Коэффициенты - constexpr std::array, порядок как в TFirFilter. Свертка развернута на этапе компиляции,
+  коэффициенты подставляются константами (нулевые и повторяющиеся компилятор сокращает).
+  История - линия задержки двойной длины: каждый отсчет пишется два раза, окно всегда непрерывно.
+  \tparam T тип отсчета.
+  \tparam COEFFS коэффициенты (ссылка на constexpr std::array<C, TAPS> со статическим временем жизни).
+*/
+class TFixedFirFilter
+{
+public:
+	using C = typename std::remove_cv_t<std::remove_reference_t<decltype(COEFFS)>>::value_type; ///< тип коэффициентов и сумм.
+	static constexpr int TAPS = std::tuple_size_v<std::remove_cv_t<std::remove_reference_t<decltype(COEFFS)>>>; ///< количество коэффициентов.
+
+protected:
+	static_assert(TAPS > 0, "filter must have taps");
+
+	T mLine[2 * TAPS] = {}; ///< линия задержки, окно - mLine[mPos..mPos + TAPS - 1].
+	int mPos = 0;			///< начало окна (самый старый отсчет).
+
+	template <size_t... I>
+	/// Свертка окна.
+	/*!
+	  \param[in] x окно, TAPS отсчетов.
+	  \return сумма x[i]*COEFFS[i].
+	*/
+	static inline C dot(const T *__restrict x, std::index_sequence<I...>)
+	{
+		return ((COEFFS[I] * (C)x[I]) + ...);
+	}
+
+public:
+	/// Применить фильтр к последним TAPS отсчетам FIFO.
+	/*!
+	  \param[in] fifo FIFO размером не меньше TAPS.
+	  \return выход фильтра.
+	*/
+	template <int N, typename Alloc>
+	static C apply(TFifoArray<T, N, Alloc> &fifo)
+	{
+		TFifoSpans<T> s = fifo.spans(TAPS);
+		return fifoDot(s.first, COEFFS.data(), s.firstSize) + fifoDot(s.second, &COEFFS[s.firstSize], s.secondSize);
+	}
+
+	/// Обработать отсчет.
+	/*!
+	  \param[in] x отсчет.
+	  \return выход фильтра.
+	*/
+	inline C process(T x)
+	{
+		mLine[mPos] = x;
+		mLine[mPos + TAPS] = x;
+		if (++mPos == TAPS)
+			mPos = 0;
+		return dot(&mLine[mPos], std::make_index_sequence<TAPS>{});
+	}
+
+	/// Обработать блок.
+	/*!
+	  \param[in] in входные отсчеты.
+	  \param[out] out выходные отсчеты, может совпадать с in.
+	  \param[in] count количество отсчетов.
+	*/
+	void process(const T *in, T *out, int count)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = (T)process(in[i]);
+	}
+
+	/// Обработать участки FIFO.
+	/*!
+	  \param[in] in участки, например, spans() входного FIFO.
+	  \param[out] out выходные отсчеты, in.firstSize + in.secondSize.
+	*/
+	inline void process(const TFifoSpans<T> &in, T *out)
+	{
+		process(in.first, out, in.firstSize);
+		process(in.second, &out[in.firstSize], in.secondSize);
+	}
+
+	/// Сброс состояния.
+	inline void clear()
+	{
+		std::memset(mLine, 0, sizeof(mLine));
+		mPos = 0;
+	}
+};
+
+/// Коэффициенты звена биквадратного фильтра, a0 = 1.
+struct SBiquad
+{
+	float b0; ///< коэффициент b0.
+	float b1; ///< коэффициент b1.
+	float b2; ///< коэффициент b2.
+	float a1; ///< коэффициент a1.
+	float a2; ///< коэффициент a2.
+};
+
+template <typename T, int SECTIONS = 1>
+/// Потоковый БИХ (IIR) фильтр из последовательных биквадратных звеньев.
+/*!
+  Транспонированная прямая форма II, состояние в float.
+  \tparam T тип отсчета.
+  \tparam SECTIONS количество звеньев.
+*/
+class TBiquadFilter
+{
+	static_assert(SECTIONS > 0, "filter must have sections");
+
+protected:
+	const SBiquad *mSections;	 ///< коэффициенты звеньев.
+	float mState[SECTIONS][2] = {}; ///< состояние звеньев.
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] sections коэффициенты, SECTIONS элементов. Память не копируется.
+	*/
+	TBiquadFilter(const SBiquad *sections) : mSections(sections)
+	{
+	}
+
+	/// Обработать отсчет.
+	/*!
+	  \param[in] x отсчет.
+	  \return выход фильтра.
+	*/
+	inline float process(T x)
+	{
+		float y = x;
+		for (int i = 0; i < SECTIONS; i++)
+		{
+			const SBiquad &s = mSections[i];
+			float in = y;
+			y = s.b0 * in + mState[i][0];
+			mState[i][0] = s.b1 * in - s.a1 * y + mState[i][1];
+			mState[i][1] = s.b2 * in - s.a2 * y;
+		}
+		return y;
+	}
+
+	/// Обработать блок.
+	/*!
+	  \param[in] in входные отсчеты.
+	  \param[out] out выходные отсчеты, может совпадать с in.
+	  \param[in] count количество отсчетов.
+	*/
+	void process(const T *in, T *out, int count)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = (T)process(in[i]);
+	}
+
+	/// Обработать участки FIFO.
+	/*!
+	  \param[in] in участки, например, spans() входного FIFO.
+	  \param[out] out выходные отсчеты, in.firstSize + in.secondSize.
+	*/
+	inline void process(const TFifoSpans<T> &in, T *out)
+	{
+		process(in.first, out, in.firstSize);
+		process(in.second, &out[in.firstSize], in.secondSize);
+	}
+
+	/// Сброс состояния.
+	inline void clear() { std::memset(mState, 0, sizeof(mState)); }
+};
+
+#endif // TFIFOFILTER_H
@@ -0,0 +1,264 @@
+/*!
+	\file
+	\brief Шаблон FIFO буфера с несколькими читателями.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TMULTIFIFOARRAY_H
+#define TMULTIFIFOARRAY_H
+
+#include <atomic>
+#include <type_traits>
+#include "TFifoArray.h"
+
+template <typename T, int N = 0, int READERS = 4, typename Alloc = TNewAllocator>
+/// Шаблон FIFO буфера с одним производителем и несколькими читателями.
+/*!
+  Каждый читатель (курсор) читает весь поток со своей скоростью из общего буфера.
+  Курсор с обратным давлением не дает производителю перезаписать непрочитанные данные: push() записывает сколько поместилось.
+  Обычный курсор не задерживает производителя, а при отставании больше размера буфера пропускает данные (см. getOverruns()).
+  Перезапись во время копирования обнаруживается по индексу резервирования производителя, как в TSeqLock.
+  Функции производителя вызываются из одной задачи, функции курсора - из задачи этого курсора.
+  \tparam T тип элемента, копируется через memcpy.
+  \tparam N размер, если 0, то размер задается в конструкторе и память выделяется в куче.
+  \tparam READERS максимальное количество курсоров.
+  \tparam Alloc выделение памяти для N = 0, см. TFifoArray.
+*/
+class TMultiFifoArray : protected TFifoStorage<T, N, Alloc>
+{
+	static_assert(std::is_trivially_copyable_v<T>, "TMultiFifoArray data must be trivially copyable");
+
+protected:
+	using TFifoStorage<T, N, Alloc>::mBuffer;
+	using TFifoStorage<T, N, Alloc>::mSize;
+	using TFifoStorage<T, N, Alloc>::wrap;
+
+	static constexpr uint8_t CURSOR_FREE = 0;	 ///< курсор свободен.
+	static constexpr uint8_t CURSOR_CLAIMED = 1; ///< курсор занят и инициализируется.
+	static constexpr uint8_t CURSOR_ACTIVE = 2;	 ///< курсор используется.
+
+	/// Курсор читателя.
+	struct SCursor
+	{
+		std::atomic<uint8_t> state{CURSOR_FREE}; ///< состояние курсора.
+		bool backpressure = false;				  ///< курсор задерживает производителя.
+		std::atomic<uint32_t> pos{0};			  ///< счетчик прочитанных элементов.
+		std::atomic<uint32_t> overruns{0};		  ///< количество пропущенных элементов.
+	};
+
+	// Счетчики элементов идут по модулю mLimit, кратному размеру, поэтому позиция в буфере не зависит от переполнения.
+	uint32_t mLimit;				///< модуль счетчиков.
+	std::atomic<uint32_t> mHead{0};	///< счетчик записанных элементов.
+	std::atomic<uint32_t> mReserve{0}; ///< счетчик элементов, запись которых начата.
+	SCursor mCursors[READERS];		///< курсоры.
+
+	/// Сдвинуть счетчик.
+	/*!
+	  \param[in] counter счетчик.
+	  \param[in] count сдвиг.
+	  \return счетчик по модулю mLimit.
+	*/
+	inline uint32_t advance(uint32_t counter, uint32_t count) const
+	{
+		counter += count;
+		return (counter >= mLimit) ? (counter - mLimit) : counter;
+	}
+
+	/// Расстояние между счетчиками.
+	/*!
+	  \param[in] to больший счетчик.
+	  \param[in] from меньший счетчик.
+	  \return количество элементов.
+	*/
+	inline uint32_t distance(uint32_t to, uint32_t from) const
+	{
+		return (to >= from) ? (to - from) : (to + mLimit - from);
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. Для N > 0 можно не указывать.
+	*/
+	TMultiFifoArray(int size = N) : TFifoStorage<T, N, Alloc>(size)
+	{
+		mLimit = (uint32_t)mSize * (0x80000000u / (uint32_t)mSize);
+	}
+
+	/// Получить размер буфера.
+	/*!
+	  \return размер.
+	*/
+	inline int getSize() const { return mSize; };
+
+	/// Добавить курсор.
+	/*!
+	  Курсор начинает чтение с элементов, записанных после добавления.
+	  \param[in] backpressure Не перезаписывать непрочитанные курсором данные.
+	  \return Номер курсора или -1, если свободных курсоров нет.
+	*/
+	int addCursor(bool backpressure = false)
+	{
+		for (int i = 0; i < READERS; i++)
+		{
+			SCursor &c = mCursors[i];
+			uint8_t expected = CURSOR_FREE;
+			// Захват слота атомарный: задачи, добавляющие курсоры одновременно, получают разные слоты.
+			if (c.state.compare_exchange_strong(expected, CURSOR_CLAIMED, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				c.backpressure = backpressure;
+				c.overruns.store(0, std::memory_order_relaxed);
+				c.pos.store(mHead.load(std::memory_order_acquire), std::memory_order_relaxed);
+				c.state.store(CURSOR_ACTIVE, std::memory_order_release);
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	/// Удалить курсор.
+	/*!
+	  \param[in] id Номер курсора.
+	*/
+	inline void removeCursor(int id)
+	{
+		assert((id >= 0) && (id < READERS));
+		mCursors[id].state.store(CURSOR_FREE, std::memory_order_release);
+	}
+
+	/// Внести данные в FIFO (производитель).
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \return количество принятых элементов, меньше size только при обратном давлении курсоров.
+	*/
+	int push(const T *data, int size)
+	{
+		uint32_t head = mHead.load(std::memory_order_relaxed);
+		int n = size;
+		bool backpressure = false;
+		for (int i = 0; i < READERS; i++)
+		{
+			SCursor &c = mCursors[i];
+			if ((c.state.load(std::memory_order_acquire) == CURSOR_ACTIVE) && c.backpressure)
+			{
+				int free = mSize - (int)distance(head, c.pos.load(std::memory_order_acquire));
+				if (free < n)
+					n = free;
+				backpressure = true;
+			}
+		}
+		if (n <= 0)
+			return 0;
+		// Без обратного давления в буфер попадают только последние mSize элементов, остальные считаются пропущенными.
+		int write = (n > mSize) ? mSize : n;
+		uint32_t end = advance(head, n);
+
+		mReserve.store(end, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		int pos = wrap((int)end - write);
+		int first = mSize - pos;
+		const T *src = &data[n - write];
+		if (write <= first)
+		{
+			std::memcpy(&mBuffer[pos], src, sizeof(T) * write);
+		}
+		else
+		{
+			std::memcpy(&mBuffer[pos], src, sizeof(T) * first);
+			std::memcpy(mBuffer, &src[first], sizeof(T) * (write - first));
+		}
+		mHead.store(end, std::memory_order_release);
+		return backpressure ? n : size;
+	}
+
+	/// Внести данные в FIFO (производитель).
+	/*!
+	  \param[in] value данные.
+	  \return true, если элемент принят.
+	*/
+	inline bool push(const T &value)
+	{
+		return push(&value, 1) == 1;
+	}
+
+	/// Количество непрочитанных курсором элементов.
+	/*!
+	  \param[in] id Номер курсора.
+	  \return количество, может быть больше размера буфера при отставании.
+	*/
+	inline int getAvailable(int id) const
+	{
+		assert((id >= 0) && (id < READERS));
+		return distance(mHead.load(std::memory_order_acquire), mCursors[id].pos.load(std::memory_order_relaxed));
+	}
+
+	/// Прочитать данные курсором.
+	/*!
+	  Не более двух memcpy.
+	  \param[in] id Номер курсора.
+	  \param[out] dst буфер.
+	  \param[in] count размер буфера.
+	  \return количество прочитанных элементов.
+	*/
+	int read(int id, T *dst, int count)
+	{
+		assert((id >= 0) && (id < READERS));
+		SCursor &c = mCursors[id];
+		uint32_t pos = c.pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			uint32_t head = mHead.load(std::memory_order_acquire);
+			uint32_t avail = distance(head, pos);
+			if (avail > (uint32_t)mSize)
+			{
+				c.overruns.fetch_add(avail - mSize, std::memory_order_relaxed);
+				pos = advance(pos, avail - mSize);
+				avail = mSize;
+			}
+			int n = ((uint32_t)count < avail) ? count : (int)avail;
+
+			int start = wrap((int)pos);
+			int first = mSize - start;
+			if (n <= first)
+			{
+				std::memcpy(dst, &mBuffer[start], sizeof(T) * n);
+			}
+			else
+			{
+				std::memcpy(dst, &mBuffer[start], sizeof(T) * first);
+				std::memcpy(&dst[first], mBuffer, sizeof(T) * (n - first));
+			}
+
+			if (!c.backpressure)
+			{
+				// Если производитель за время копирования начал перезапись прочитанных элементов, то чтение повторяется.
+				std::atomic_thread_fence(std::memory_order_acquire);
+				uint32_t ahead = distance(mReserve.load(std::memory_order_relaxed), pos);
+				if (ahead > (uint32_t)mSize)
+				{
+					c.overruns.fetch_add(ahead - mSize, std::memory_order_relaxed);
+					pos = advance(pos, ahead - mSize);
+					continue;
+				}
+			}
+			c.pos.store(advance(pos, n), std::memory_order_release);
+			return n;
+		}
+	}
+
+	/// Количество пропущенных курсором элементов.
+	/*!
+	  \param[in] id Номер курсора.
+	  \return количество.
+	*/
+	inline uint32_t getOverruns(int id) const
+	{
+		assert((id >= 0) && (id < READERS));
+		return mCursors[id].overruns.load(std::memory_order_relaxed);
+	}
+};
+
+#endif // TMULTIFIFOARRAY_H
@@ -0,0 +1,108 @@
+/*!
+	\file
+	\brief Шаблон публикации данных одним писателем для многих читателей без блокировки.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TSEQLOCK_H
+#define TSEQLOCK_H
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+/// Шаблон последовательной блокировки (seqlock).
+/*!
+  Писатель увеличивает счетчик (нечетный - идет запись), копирует данные и снова увеличивает счетчик.
+  Читатель копирует данные и повторяет чтение, если счетчик изменился. Читатели не блокируют писателя.
+  Писатель должен быть один (или писатели должны быть сериализованы снаружи).
+  Функции встраиваются в вызывающий код, поэтому доступны из прерываний.
+  В прерывании, которое может прервать писателя на том же ядре, используется tryRead().
+*/
+class TSeqLock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "TSeqLock data must be trivially copyable");
+
+protected:
+	std::atomic<uint32_t> mSeq{0}; ///< Счетчик записей, нечетный во время записи.
+	T mData;					   ///< Данные.
+
+	/// Попытка чтения.
+	/*!
+	  \param[out] data Данные.
+	  \param[out] seq Счетчик записей.
+	  \return true, если данные не менялись во время чтения.
+	*/
+	inline __attribute__((always_inline)) bool readOnce(T *data, uint32_t &seq)
+	{
+		seq = mSeq.load(std::memory_order_acquire);
+		if ((seq & 1) != 0)
+			return false;
+		std::memcpy(data, &mData, sizeof(T));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return mSeq.load(std::memory_order_relaxed) == seq;
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] data Начальные данные.
+	*/
+	TSeqLock(const T &data = T()) : mData(data) {}
+
+	/// Записать данные.
+	/*!
+	  \param[in] data Данные.
+	*/
+	inline __attribute__((always_inline)) void write(const T &data)
+	{
+		uint32_t seq = mSeq.load(std::memory_order_relaxed);
+		mSeq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(&mData, &data, sizeof(T));
+		mSeq.store(seq + 2, std::memory_order_release);
+	}
+
+	/// Прочитать данные.
+	/*!
+	  Повторяет чтение, пока не получит целостную копию.
+	  \param[out] data Данные.
+	  \return Номер записи.
+	*/
+	inline __attribute__((always_inline)) uint32_t read(T *data)
+	{
+		uint32_t seq;
+		while (!readOnce(data, seq))
+		{
+		}
+		return seq >> 1;
+	}
+
+	/// Прочитать данные с ограниченным количеством попыток.
+	/*!
+	  \param[out] data Данные.
+	  \param[in] retries Количество попыток.
+	  \return true, если получена целостная копия.
+	*/
+	inline __attribute__((always_inline)) bool tryRead(T *data, uint32_t retries = 8)
+	{
+		uint32_t seq;
+		for (uint32_t i = 0; i < retries; i++)
+		{
+			if (readOnce(data, seq))
+				return true;
+		}
+		return false;
+	}
+
+	/// Номер записи.
+	/*!
+	  \return Количество завершенных записей.
+	*/
+	inline uint32_t getVersion() { return mSeq.load(std::memory_order_acquire) >> 1; }
+};
+
+#endif // TSEQLOCK_H
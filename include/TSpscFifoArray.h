@@ -0,0 +1,251 @@
+/*!
+	\file
+	\brief Шаблон FIFO буфера без блокировки для одного производителя и одного потребителя.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TSPSCFIFOARRAY_H
+#define TSPSCFIFOARRAY_H
+
+#include <atomic>
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "TFifoArray.h"
+
+template <typename T, int N = 0, typename Alloc = TNewAllocator>
+/// Шаблон FIFO буфера для передачи потока из прерывания или задачи в задачу.
+/*!
+  Один производитель и один потребитель, индексы записи и чтения атомарные, блокировок нет.
+  Заполненный буфер не перезаписывается: push() записывает сколько поместилось, остальное учитывается в getLost().
+  Потребитель получает бит уведомления задачи, когда количество элементов достигает порога.
+  Уведомление отправляется только при переходе порога, поэтому потребитель выбирает данные pop(), пока их не станет меньше порога.
+  \tparam T тип элемента, копируется через memcpy.
+  \tparam N размер, если 0, то размер задается в конструкторе и память выделяется в куче.
+  \tparam Alloc выделение памяти для N = 0, см. TFifoArray.
+*/
+class TSpscFifoArray : protected TFifoStorage<T, N, Alloc>
+{
+	static_assert(std::is_trivially_copyable_v<T>, "TSpscFifoArray data must be trivially copyable");
+
+protected:
+	using TFifoStorage<T, N, Alloc>::mBuffer;
+	using TFifoStorage<T, N, Alloc>::mSize;
+
+	// Индексы от 0 до 2*mSize-1: так полный буфер отличается от пустого при любом размере.
+	std::atomic<int> mHead{0};	///< индекс записи (производитель).
+	std::atomic<int> mTail{0};	///< индекс чтения (потребитель).
+	std::atomic<uint32_t> mLost{0}; ///< количество отброшенных элементов (производитель).
+
+	TaskHandle_t mTaskToNotify = nullptr; ///< задача потребителя.
+	uint32_t mNotifyBit = 0;			  ///< бит уведомления.
+	int mWatermark = 1;					  ///< порог уведомления.
+
+	/// Сдвинуть индекс.
+	/*!
+	  \param[in] index индекс.
+	  \param[in] count сдвиг, не больше mSize.
+	  \return индекс от 0 до 2*mSize-1.
+	*/
+	inline __attribute__((always_inline)) int advance(int index, int count) const
+	{
+		index += count;
+		return (index >= (2 * mSize)) ? (index - 2 * mSize) : index;
+	}
+
+	/// Позиция индекса в буфере.
+	/*!
+	  \param[in] index индекс.
+	  \return позиция от 0 до mSize-1.
+	*/
+	inline __attribute__((always_inline)) int position(int index) const
+	{
+		return (index >= mSize) ? (index - mSize) : index;
+	}
+
+	/// Количество элементов.
+	/*!
+	  \param[in] head индекс записи.
+	  \param[in] tail индекс чтения.
+	  \return количество.
+	*/
+	inline __attribute__((always_inline)) int count(int head, int tail) const
+	{
+		int n = head - tail;
+		return (n < 0) ? (n + 2 * mSize) : n;
+	}
+
+	/// Записать данные (производитель).
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \return true, если нужно уведомить потребителя.
+	*/
+	inline __attribute__((always_inline)) bool write(const T *data, int size)
+	{
+		int head = mHead.load(std::memory_order_relaxed);
+		int tail = mTail.load(std::memory_order_acquire);
+		int used = count(head, tail);
+		int n = mSize - used;
+		if (size > n)
+		{
+			// Пишет только производитель, поэтому достаточно load/store без RMW.
+			mLost.store(mLost.load(std::memory_order_relaxed) + (size - n), std::memory_order_relaxed);
+			size = n;
+		}
+		if (size == 0)
+			return false;
+
+		int pos = position(head);
+		int first = mSize - pos;
+		if (size <= first)
+		{
+			std::memcpy(&mBuffer[pos], data, sizeof(T) * size);
+		}
+		else
+		{
+			std::memcpy(&mBuffer[pos], data, sizeof(T) * first);
+			std::memcpy(mBuffer, &data[first], sizeof(T) * (size - first));
+		}
+		head = advance(head, size);
+		// Запись индекса и повторное чтение индекса потребителя последовательно согласованы:
+		// либо потребитель увидит новые данные, либо производитель увидит его опустошение и отправит уведомление.
+		mHead.store(head, std::memory_order_seq_cst);
+		if (mTaskToNotify == nullptr)
+			return false;
+		used = count(head, mTail.load(std::memory_order_seq_cst));
+		return ((used - size) < mWatermark) && (used >= mWatermark);
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. Для N > 0 можно не указывать.
+	*/
+	TSpscFifoArray(int size = N) : TFifoStorage<T, N, Alloc>(size)
+	{
+	}
+
+	/// Задать потребителя.
+	/*!
+	  Вызывается до начала передачи.
+	  \param[in] task Задача потребителя. Если nullptr, то уведомления не отправляются.
+	  \param[in] xNotifyBit Бит уведомления.
+	  \param[in] watermark Количество элементов для уведомления, от 1 до размера буфера.
+	*/
+	void setNotify(TaskHandle_t task, uint8_t xNotifyBit, int watermark = 1)
+	{
+		assert((watermark > 0) && (watermark <= mSize));
+		mNotifyBit = (1u << xNotifyBit);
+		mWatermark = watermark;
+		mTaskToNotify = task;
+	}
+
+	/// Получить размер буфера.
+	/*!
+	  \return размер.
+	*/
+	inline int getSize() const { return mSize; };
+
+	/// Внести данные в FIFO из задачи (производитель).
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	*/
+	inline void push(const T *data, int size)
+	{
+		if (write(data, size))
+			xTaskNotify(mTaskToNotify, mNotifyBit, eSetBits);
+	}
+
+	/// Внести данные в FIFO из задачи (производитель).
+	/*!
+	  \param[in] value данные.
+	*/
+	inline void push(const T &value)
+	{
+		push(&value, 1);
+	}
+
+	/// Внести данные в FIFO из прерывания (производитель).
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \param[out] pxHigherPriorityTaskWoken Флаг переключения задач.
+	*/
+	inline __attribute__((always_inline)) void pushFromISR(const T *data, int size, BaseType_t *pxHigherPriorityTaskWoken)
+	{
+		if (write(data, size))
+			xTaskNotifyFromISR(mTaskToNotify, mNotifyBit, eSetBits, pxHigherPriorityTaskWoken);
+	}
+
+	/// Внести данные в FIFO из прерывания (производитель).
+	/*!
+	  \param[in] value данные.
+	  \param[out] pxHigherPriorityTaskWoken Флаг переключения задач.
+	*/
+	inline __attribute__((always_inline)) void pushFromISR(const T &value, BaseType_t *pxHigherPriorityTaskWoken)
+	{
+		pushFromISR(&value, 1, pxHigherPriorityTaskWoken);
+	}
+
+	/// Извлечь данные из FIFO (потребитель).
+	/*!
+	  \param[out] data буфер.
+	  \param[in] size размер буфера.
+	  \return количество извлеченных элементов.
+	*/
+	int pop(T *data, int size)
+	{
+		int tail = mTail.load(std::memory_order_relaxed);
+		int head = mHead.load(std::memory_order_seq_cst);
+		int n = count(head, tail);
+		if (size > n)
+			size = n;
+		if (size == 0)
+			return 0;
+
+		int pos = position(tail);
+		int first = mSize - pos;
+		if (size <= first)
+		{
+			std::memcpy(data, &mBuffer[pos], sizeof(T) * size);
+		}
+		else
+		{
+			std::memcpy(data, &mBuffer[pos], sizeof(T) * first);
+			std::memcpy(&data[first], mBuffer, sizeof(T) * (size - first));
+		}
+		mTail.store(advance(tail, size), std::memory_order_seq_cst);
+		return size;
+	}
+
+	/// Извлечь элемент из FIFO (потребитель).
+	/*!
+	  \param[out] value элемент.
+	  \return true, если FIFO не пустой.
+	*/
+	inline bool pop(T &value)
+	{
+		return pop(&value, 1) == 1;
+	}
+
+	/// Количество элементов в FIFO.
+	/*!
+	  \return количество.
+	*/
+	inline int getCount() const
+	{
+		return count(mHead.load(std::memory_order_seq_cst), mTail.load(std::memory_order_seq_cst));
+	}
+
+	/// Количество отброшенных элементов заполненного буфера.
+	/*!
+	  \return количество.
+	*/
+	inline uint32_t getLost() const { return mLost.load(std::memory_order_relaxed); };
+};
+
+#endif // TSPSCFIFOARRAY_H
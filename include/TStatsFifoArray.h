@@ -0,0 +1,369 @@
+/*!
+	\file
+	\brief Шаблон FIFO буфера со статистикой скользящего окна.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TSTATSFIFOARRAY_H
+#define TSTATSFIFOARRAY_H
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include "TFifoArray.h"
+
+template <typename T, typename A = std::conditional_t<std::is_floating_point_v<T>, T, int64_t>>
+/// Вычисление статистики по непрерывным участкам данных.
+/*!
+  Простые циклы без зависимостей между итерациями, которые компилятор может векторизовать.
+  \tparam T тип элемента.
+  \tparam A тип сумм.
+*/
+struct TSpanStats
+{
+	/// Сумма.
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \return сумма.
+	*/
+	static A sum(const T *__restrict data, int size)
+	{
+		A s = 0;
+		for (int i = 0; i < size; i++)
+			s += data[i];
+		return s;
+	}
+
+	/// Сумма квадратов.
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \return сумма квадратов.
+	*/
+	static A sumSquares(const T *__restrict data, int size)
+	{
+		A s = 0;
+		for (int i = 0; i < size; i++)
+			s += (A)data[i] * (A)data[i];
+		return s;
+	}
+
+	/// Минимум.
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных, больше 0.
+	  \return минимум.
+	*/
+	static T min(const T *__restrict data, int size)
+	{
+		T m = data[0];
+		for (int i = 1; i < size; i++)
+			m = (data[i] < m) ? data[i] : m;
+		return m;
+	}
+
+	/// Максимум.
+	/*!
+	  \param[in] data данные.
+	  \param[in] size размер данных, больше 0.
+	  \return максимум.
+	*/
+	static T max(const T *__restrict data, int size)
+	{
+		T m = data[0];
+		for (int i = 1; i < size; i++)
+			m = (data[i] > m) ? data[i] : m;
+		return m;
+	}
+
+	/// Минимум по двум участкам FIFO.
+	/*!
+	  \param[in] s участки, хотя бы один элемент.
+	  \return минимум.
+	*/
+	static T min(const TFifoSpans<T> &s)
+	{
+		T m = min(s.first, s.firstSize);
+		return (s.secondSize == 0) ? m : std::min(m, min(s.second, s.secondSize));
+	}
+
+	/// Максимум по двум участкам FIFO.
+	/*!
+	  \param[in] s участки, хотя бы один элемент.
+	  \return максимум.
+	*/
+	static T max(const TFifoSpans<T> &s)
+	{
+		T m = max(s.first, s.firstSize);
+		return (s.secondSize == 0) ? m : std::max(m, max(s.second, s.secondSize));
+	}
+
+	/// Сумма по двум участкам FIFO.
+	/*!
+	  \param[in] s участки.
+	  \return сумма.
+	*/
+	static inline A sum(const TFifoSpans<T> &s) { return sum(s.first, s.firstSize) + sum(s.second, s.secondSize); }
+
+	/// Сумма квадратов по двум участкам FIFO.
+	/*!
+	  \param[in] s участки.
+	  \return сумма квадратов.
+	*/
+	static inline A sumSquares(const TFifoSpans<T> &s) { return sumSquares(s.first, s.firstSize) + sumSquares(s.second, s.secondSize); }
+};
+
+template <typename T, int N = 0, typename A = std::conditional_t<std::is_floating_point_v<T>, T, int64_t>, typename Alloc = TNewAllocator>
+/// Шаблон FIFO буфера со статистикой последних элементов.
+/*!
+  Сумма и сумма квадратов обновляются при каждом push(), минимум и максимум хранятся в монотонных очередях,
+  поэтому статистика окна получается за O(1) на элемент.
+  Для чисел с плавающей точкой суммы пересчитываются целиком после каждых getSize() элементов, чтобы не накапливалась ошибка.
+  Окно - последние getCount() элементов, до заполнения буфера их меньше размера.
+  Данные изменяются только через push() и clear() этого класса.
+  \tparam T тип элемента.
+  \tparam N размер, если 0, то размер задается в конструкторе и память выделяется в куче.
+  \tparam A тип сумм.
+  \tparam Alloc выделение памяти буфера и очередей минимума и максимума для N = 0, см. TFifoArray.
+  Для N > 0 очереди, как и буфер, внутри объекта.
+*/
+class TStatsFifoArray : public TFifoArray<T, N, Alloc>
+{
+protected:
+	using TFifoArray<T, N, Alloc>::mBuffer;
+	using TFifoArray<T, N, Alloc>::mSize;
+	using TFifoArray<T, N, Alloc>::mIndex;
+
+	/// Элемент монотонной очереди.
+	struct SItem
+	{
+		T value;	  ///< значение.
+		uint32_t seq; ///< номер элемента.
+	};
+
+	/// Монотонная очередь: значения от начала к концу возрастают (минимум) или убывают (максимум).
+	/*!
+	  Память как у буфера: для N > 0 внутри объекта, иначе через Alloc.
+	*/
+	struct SDeque : public TFifoStorage<SItem, N, Alloc>
+	{
+		using TFifoStorage<SItem, N, Alloc>::mBuffer;
+
+		int first = 0; ///< индекс первого элемента.
+		int count = 0; ///< количество элементов.
+
+		/// Конструктор.
+		/*!
+		  \param[in] size размер.
+		*/
+		SDeque(int size) : TFifoStorage<SItem, N, Alloc>(size) {}
+	};
+
+	int mCount = 0;		 ///< количество элементов в окне.
+	uint32_t mSeq = 0;	 ///< номер следующего элемента.
+	int mRecompute = 0;	 ///< количество элементов до полного пересчета сумм.
+	A mSum = 0;			 ///< сумма.
+	A mSumSquares = 0;	 ///< сумма квадратов.
+	SDeque mMin;		 ///< очередь минимума.
+	SDeque mMax;		 ///< очередь максимума.
+
+	/// Добавить значение в монотонную очередь.
+	/*!
+	  \param[in,out] q очередь.
+	  \param[in] value значение.
+	  \param[in] less true для минимума.
+	*/
+	void enqueue(SDeque &q, T value, bool less)
+	{
+		// Из очереди уходит первый элемент, вышедший из окна.
+		if ((q.count != 0) && ((mSeq - q.mBuffer[q.first].seq) >= (uint32_t)mSize))
+		{
+			q.first = (q.first == (mSize - 1)) ? 0 : (q.first + 1);
+			q.count--;
+		}
+		// С конца уходят элементы, которые уже не могут стать экстремумом.
+		while (q.count != 0)
+		{
+			int last = q.first + q.count - 1;
+			if (last >= mSize)
+				last -= mSize;
+			if (less ? (q.mBuffer[last].value < value) : (q.mBuffer[last].value > value))
+				break;
+			q.count--;
+		}
+		int i = q.first + q.count;
+		if (i >= mSize)
+			i -= mSize;
+		q.mBuffer[i] = {value, mSeq};
+		q.count++;
+	}
+
+	/// Добавить значение в статистику.
+	/*!
+	  \param[in] value значение.
+	  \param[in] old вытесняемое значение, если окно заполнено.
+	*/
+	void update(T value, T old)
+	{
+		if (mCount == mSize)
+		{
+			mSum -= old;
+			mSumSquares -= (A)old * (A)old;
+		}
+		else
+		{
+			mCount++;
+		}
+		mSum += value;
+		mSumSquares += (A)value * (A)value;
+		enqueue(mMin, value, true);
+		enqueue(mMax, value, false);
+		mSeq++;
+	}
+
+	/// Пересчитать суммы по всему окну.
+	void recompute()
+	{
+		TFifoSpans<T> s = this->spans(mCount);
+		mSum = TSpanStats<T, A>::sum(s);
+		mSumSquares = TSpanStats<T, A>::sumSquares(s);
+		mRecompute = mSize;
+	}
+
+	/// Перестроить статистику по всему окну.
+	void rebuild()
+	{
+		mMin.count = 0;
+		mMax.count = 0;
+		TFifoSpans<T> s = this->spans(mCount);
+		mSeq -= mCount;
+		for (int i = 0; i < s.firstSize; i++)
+		{
+			enqueue(mMin, s.first[i], true);
+			enqueue(mMax, s.first[i], false);
+			mSeq++;
+		}
+		for (int i = 0; i < s.secondSize; i++)
+		{
+			enqueue(mMin, s.second[i], true);
+			enqueue(mMax, s.second[i], false);
+			mSeq++;
+		}
+		recompute();
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. Для N > 0 можно не указывать.
+	*/
+	TStatsFifoArray(int size = N) : TFifoArray<T, N, Alloc>(size), mMin(mSize), mMax(mSize)
+	{
+		mRecompute = mSize;
+	}
+
+	TStatsFifoArray(const TStatsFifoArray &) = delete;
+	TStatsFifoArray &operator=(const TStatsFifoArray &) = delete;
+
+	/// Внести данные в FIFO.
+	/*!
+	  \param[in] value данные.
+	*/
+	void push(T value)
+	{
+		update(value, mBuffer[mIndex]);
+		TFifoArray<T, N, Alloc>::push(value);
+		if constexpr (std::is_floating_point_v<A>)
+		{
+			if (--mRecompute == 0)
+				recompute();
+		}
+	}
+
+	/// Внести данные в FIFO.
+	/*!
+	  Если данных не меньше размера буфера, то статистика пересчитывается целиком.
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	*/
+	void push(const T *data, int size)
+	{
+		if (size >= mSize)
+		{
+			TFifoArray<T, N, Alloc>::push(data, size);
+			mSeq += size;
+			mCount = mSize;
+			rebuild();
+			return;
+		}
+		for (int i = 0; i < size; i++)
+			push(data[i]);
+	}
+
+	/// Очистка FIFO и статистики.
+	void clear()
+	{
+		TFifoArray<T, N, Alloc>::clear();
+		mCount = 0;
+		mSum = 0;
+		mSumSquares = 0;
+		mMin.count = 0;
+		mMax.count = 0;
+		mRecompute = mSize;
+	}
+
+	/// Количество элементов в окне.
+	/*!
+	  \return количество.
+	*/
+	inline int getCount() const { return mCount; };
+
+	/// Сумма элементов окна.
+	/*!
+	  \return сумма.
+	*/
+	inline A getSum() const { return mSum; };
+
+	/// Минимум окна.
+	/*!
+	  \return минимум, окно не пустое.
+	*/
+	inline T getMin() const
+	{
+		assert(mCount != 0);
+		return mMin.mBuffer[mMin.first].value;
+	}
+
+	/// Максимум окна.
+	/*!
+	  \return максимум, окно не пустое.
+	*/
+	inline T getMax() const
+	{
+		assert(mCount != 0);
+		return mMax.mBuffer[mMax.first].value;
+	}
+
+	/// Размах окна.
+	/*!
+	  \return максимум - минимум, окно не пустое.
+	*/
+	inline T getPeakToPeak() const { return getMax() - getMin(); };
+
+	/// Среднее окна.
+	/*!
+	  \return среднее, 0 для пустого окна.
+	*/
+	inline float getMean() const { return (mCount == 0) ? 0.0f : ((float)mSum / mCount); };
+
+	/// Среднеквадратичное значение окна.
+	/*!
+	  \return RMS, 0 для пустого окна.
+	*/
+	inline float getRms() const { return (mCount == 0) ? 0.0f : std::sqrt((float)mSumSquares / mCount); };
+};
+
+#endif // TSTATSFIFOARRAY_H
@@ -0,0 +1,148 @@
+/*!
+	\file
+	\brief Шаблон статической таблицы задач CBaseTask.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+
+	Параметры задач задаются на этапе компиляции, память под стеки, очереди и объекты задач выделяется статически.
+	Ошибки конфигурации (приоритет, стек, ядро, длина имени, бюджет стека на ядро) обнаруживаются при компиляции.
+*/
+
+#if !defined TTASKREGISTRY_H
+#define TTASKREGISTRY_H
+
+#include <new>
+#include <type_traits>
+#include "CBaseTask.h"
+
+/// Параметры задачи.
+struct STaskConfig
+{
+	const char *name;		 ///< Имя задачи длиной не более configMAX_TASK_NAME_LEN.
+	unsigned short stack;	 ///< Размер стека.
+	UBaseType_t priority;	 ///< Приоритет. Меньше configMAX_PRIORITIES.
+	UBaseType_t queueLength; ///< Максимальная длина очереди сообщений.
+	BaseType_t coreID;		 ///< Ядро CPU (0,1) или tskNO_AFFINITY.
+};
+
+/// Длина строки на этапе компиляции.
+/*!
+  \param[in] str Строка.
+  \return Длина строки.
+*/
+constexpr size_t constStrLen(const char *str)
+{
+	size_t n = 0;
+	while (str[n] != 0)
+		n++;
+	return n;
+}
+
+/// Элемент таблицы задач.
+/*!
+  \tparam T Класс задачи, наследник CBaseTask с конструктором по умолчанию.
+  \tparam Config Параметры задачи (constexpr объект STaskConfig).
+*/
+template <class T, const STaskConfig &Config>
+class TTaskEntry
+{
+	static_assert(std::is_base_of_v<CBaseTask, T>, "Task must be derived from CBaseTask");
+	static_assert(Config.priority < configMAX_PRIORITIES, "Task priority must be less than configMAX_PRIORITIES");
+	static_assert(Config.stack >= configMINIMAL_STACK_SIZE, "Task stack is less than configMINIMAL_STACK_SIZE");
+	static_assert(Config.queueLength > 0, "Task queue length must be positive");
+	static_assert((Config.coreID == tskNO_AFFINITY) || ((Config.coreID >= 0) && (Config.coreID < portNUM_PROCESSORS)), "Wrong task core");
+	static_assert(constStrLen(Config.name) < configMAX_TASK_NAME_LEN, "Task name is too long");
+
+protected:
+	static inline StackType_t mStack[Config.stack];								   ///< Стек задачи.
+	static inline StaticTask_t mTcb;											   ///< Структура задачи.
+	static inline uint8_t mQueueBuffer[Config.queueLength * sizeof(STaskMessage)]; ///< Буфер очереди.
+	static inline StaticQueue_t mQueue;											   ///< Структура очереди.
+	alignas(T) static inline uint8_t mObject[sizeof(T)];						   ///< Память под объект задачи.
+	static inline T *mTask = nullptr;											   ///< Объект задачи.
+
+public:
+	using Task = T;										 ///< Класс задачи.
+	static constexpr const STaskConfig &config = Config; ///< Параметры задачи.
+
+	/// Размер стека, приходящийся на ядро.
+	/*!
+	  \param[in] coreID Ядро CPU.
+	  \return Размер стека.
+	*/
+	static constexpr unsigned stackOnCore(BaseType_t coreID)
+	{
+		return ((Config.coreID == coreID) || (Config.coreID == tskNO_AFFINITY)) ? Config.stack : 0;
+	}
+
+	/// Создать объект и запустить задачу.
+	static void start()
+	{
+		assert(mTask == nullptr);
+		mTask = new (mObject) T();
+		mTask->CBaseTask::init(Config.name, Config.stack, Config.priority, Config.queueLength,
+							   mStack, &mTcb, mQueueBuffer, &mQueue, Config.coreID);
+	}
+
+	/// Объект задачи.
+	/*!
+	  \return Указатель на объект задачи, nullptr до start().
+	*/
+	static inline T *instance() { return mTask; }
+};
+
+/// Статическая таблица задач.
+/*!
+  \tparam StackBudget Максимальный суммарный размер стеков задач на одно ядро.
+  \tparam Entries Элементы таблицы TTaskEntry.
+*/
+template <unsigned StackBudget, class... Entries>
+class TTaskRegistry
+{
+	/// Суммарный размер стеков на ядре.
+	/*!
+	  \param[in] coreID Ядро CPU.
+	  \return Размер стеков.
+	*/
+	static constexpr unsigned stackOnCore(BaseType_t coreID)
+	{
+		return (Entries::stackOnCore(coreID) + ... + 0);
+	}
+
+	/// Проверка бюджета стека на всех ядрах.
+	/*!
+	  \return true, если бюджет не превышен.
+	*/
+	static constexpr bool checkBudget()
+	{
+		for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+		{
+			if (stackOnCore(core) > StackBudget)
+				return false;
+		}
+		return true;
+	}
+
+	static_assert(sizeof...(Entries) > 0, "Empty task registry");
+	static_assert(checkBudget(), "Task stack budget per core is exceeded");
+
+public:
+	/// Количество задач.
+	static constexpr size_t count = sizeof...(Entries);
+
+	/// Запуск всех задач в порядке таблицы.
+	static void start()
+	{
+		(Entries::start(), ...);
+	}
+
+	/// Суммарный размер стеков на ядре.
+	/*!
+	  \param[in] coreID Ядро CPU.
+	  \return Размер стеков.
+	*/
+	static constexpr unsigned getStack(BaseType_t coreID) { return stackOnCore(coreID); }
+};
+
+#endif // TTASKREGISTRY_H
@@ -0,0 +1,296 @@
+/*!
+	\file
+	\brief Шаблон FIFO буфера отсчетов с метками времени.
+	\authors Близнец Р.А. (r.bliznets@gmail.com)
+	\version 1.0.0.0
+	\date 16.10.2026
+*/
+
+#if !defined TTIMEDFIFO_H
+#define TTIMEDFIFO_H
+
+#include <cstdint>
+#include "esp_timer.h"
+#include "TFifoArray.h"
+
+/// Метка времени блока отсчетов.
+struct STimeStamp
+{
+	int64_t counter; ///< номер первого отсчета блока с начала потока.
+	int64_t time;	 ///< время первого отсчета блока (мкс).
+};
+
+template <typename T, int N = 0, typename Alloc = TNewAllocator>
+/// Шаблон FIFO буфера отсчетов с редкими метками времени.
+/*!
+  Метки хранятся для блоков, а время отдельного отсчета интерполируется между метками (поток с постоянной частотой).
+  Если время блока отличается от предсказанного не больше допуска, то метка не добавляется.
+  При смене частоты метку получает и последний совпавший с прогнозом блок: новая частота считается только по последнему блоку.
+  После последней метки время экстраполируется по частоте последнего участка или по начальной частоте.
+  Поиск по времени - двоичный поиск по меткам, O(log n).
+  Данные добавляются только через push() этого класса.
+  \tparam T тип элемента.
+  \tparam N размер, если 0, то размер задается в конструкторе и память выделяется в куче.
+  \tparam Alloc выделение памяти для N = 0, см. TFifoArray.
+*/
+class TTimedFifo : public TFifoArray<T, N, Alloc>
+{
+protected:
+	using TFifoArray<T, N, Alloc>::mSize;
+
+	TFifoArray<STimeStamp, 0, Alloc> mStamps; ///< метки времени.
+	int mStampCount = 0;			///< количество меток.
+	int64_t mTotal = 0;				///< количество отсчетов с начала потока.
+	STimeStamp mLastBlock = {0, 0}; ///< последний блок, совпавший с прогнозом или получивший метку.
+	int64_t mRateSamples;			///< частота: отсчетов за mRateTime.
+	int64_t mRateTime;				///< частота: время (мкс) для mRateSamples отсчетов.
+	uint32_t mTolerance = 0;		///< допуск времени блока (мкс).
+
+	/// Метка по номеру.
+	/*!
+	  \param[in] i номер от 0 (самая старая) до mStampCount-1.
+	  \return метка.
+	*/
+	inline STimeStamp &stamp(int i) { return mStamps[i - mStampCount]; }
+
+	/// Деление с округлением вверх.
+	/*!
+	  \param[in] a делимое.
+	  \param[in] b делитель, больше 0.
+	  \return частное.
+	*/
+	static inline int64_t divCeil(int64_t a, int64_t b)
+	{
+		return (a >= 0) ? ((a + b - 1) / b) : -((-a) / b);
+	}
+
+	/// Частота участка после метки.
+	/*!
+	  \param[in] i номер метки.
+	  \param[out] samples отсчетов за time.
+	  \param[out] time время (мкс).
+	*/
+	inline void rate(int i, int64_t &samples, int64_t &time)
+	{
+		if ((i + 1) < mStampCount)
+		{
+			samples = stamp(i + 1).counter - stamp(i).counter;
+			time = stamp(i + 1).time - stamp(i).time;
+		}
+		else
+		{
+			samples = mRateSamples;
+			time = mRateTime;
+		}
+	}
+
+	/// Добавить метку.
+	/*!
+	  \param[in] s метка.
+	*/
+	inline void addStamp(const STimeStamp &s)
+	{
+		mStamps.push(s);
+		if (mStampCount < mStamps.getSize())
+			mStampCount++;
+	}
+
+	/// Последняя метка не позже отсчета.
+	/*!
+	  \param[in] counter номер отсчета с начала потока.
+	  \return номер метки, 0 если отсчет раньше всех меток.
+	*/
+	int findByCounter(int64_t counter)
+	{
+		int lo = 0;
+		int hi = mStampCount - 1;
+		while (lo < hi)
+		{
+			int mid = (lo + hi + 1) / 2;
+			if (stamp(mid).counter <= counter)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		return lo;
+	}
+
+	/// Последняя метка не позже времени.
+	/*!
+	  \param[in] time время (мкс).
+	  \return номер метки, 0 если время раньше всех меток.
+	*/
+	int findByTime(int64_t time)
+	{
+		int lo = 0;
+		int hi = mStampCount - 1;
+		while (lo < hi)
+		{
+			int mid = (lo + hi + 1) / 2;
+			if (stamp(mid).time <= time)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		return lo;
+	}
+
+	/// Время отсчета.
+	/*!
+	  \param[in] counter номер отсчета с начала потока.
+	  \return время (мкс).
+	*/
+	int64_t timeOf(int64_t counter)
+	{
+		int i = findByCounter(counter);
+		int64_t samples, time;
+		rate(i, samples, time);
+		const STimeStamp &s = stamp(i);
+		return s.time + ((counter - s.counter) * time) / samples;
+	}
+
+	/// Первый отсчет не раньше времени.
+	/*!
+	  \param[in] time время (мкс).
+	  \return номер отсчета с начала потока.
+	*/
+	int64_t counterAt(int64_t time)
+	{
+		int i = findByTime(time);
+		int64_t samples, period;
+		rate(i, samples, period);
+		const STimeStamp &s = stamp(i);
+		return s.counter + divCeil((time - s.time) * samples, period);
+	}
+
+public:
+	/// Конструктор.
+	/*!
+	  \param[in] size размер. Для N > 0 можно не указывать.
+	  \param[in] stamps максимальное количество меток времени.
+	  \param[in] rate номинальная частота отсчетов (Гц) до появления второй метки.
+	*/
+	TTimedFifo(int size = N, int stamps = 16, uint32_t rate = 1000)
+		: TFifoArray<T, N, Alloc>(size), mStamps(stamps), mRateSamples(rate), mRateTime(1000000)
+	{
+		assert(rate > 0);
+	}
+
+	/// Задать допуск времени блока.
+	/*!
+	  \param[in] tolerance Если время блока отличается от предсказанного не больше допуска (мкс), то метка не добавляется.
+	*/
+	inline void setTolerance(uint32_t tolerance) { mTolerance = tolerance; }
+
+	/// Внести блок отсчетов.
+	/*!
+	  Метка блока, время которого не больше времени последней метки, не добавляется: время его отсчетов экстраполируется.
+	  \param[in] data данные.
+	  \param[in] size размер данных.
+	  \param[in] time время первого отсчета блока (мкс).
+	*/
+	void push(const T *data, int size, int64_t time = esp_timer_get_time())
+	{
+		if (mStampCount == 0)
+		{
+			mStamps.push({mTotal, time});
+			mStampCount = 1;
+			mLastBlock = {mTotal, time};
+		}
+		else
+		{
+			int64_t predicted = timeOf(mTotal);
+			int64_t error = (time > predicted) ? (time - predicted) : (predicted - time);
+			STimeStamp last = stamp(mStampCount - 1);
+			// Метки должны строго возрастать по времени и номеру отсчета, иначе ломается двоичный поиск и частота участка.
+			if ((error > mTolerance) && (mTotal > last.counter) && (time > last.time))
+			{
+				// Без метки последнего совпавшего блока участок старой частоты интерполировался бы по новой.
+				if ((mLastBlock.counter > last.counter) && (mLastBlock.time > last.time) && (mLastBlock.time < time))
+				{
+					addStamp(mLastBlock);
+					last = mLastBlock;
+				}
+				mRateSamples = mTotal - last.counter;
+				mRateTime = time - last.time;
+				addStamp({mTotal, time});
+				mLastBlock = {mTotal, time};
+			}
+			else if (error <= mTolerance)
+			{
+				mLastBlock = {mTotal, time};
+			}
+		}
+		TFifoArray<T, N, Alloc>::push(data, size);
+		mTotal += size;
+	}
+
+	/// Внести отсчет.
+	/*!
+	  \param[in] value отсчет.
+	  \param[in] time время отсчета (мкс).
+	*/
+	inline void push(T value, int64_t time = esp_timer_get_time())
+	{
+		push(&value, 1, time);
+	}
+
+	/// Время отсчета по индексу.
+	/*!
+	  \param[in] index индекс как в operator[], от -getSize() до -1 - последние отсчеты.
+	  \return время (мкс).
+	*/
+	inline int64_t getTime(int index)
+	{
+		assert(mStampCount != 0);
+		return timeOf(mTotal + ((index < 0) ? index : (index - mSize)));
+	}
+
+	/// Получить отсчеты за интервал времени.
+	/*!
+	  \param[in] t0 начало интервала (мкс), включительно.
+	  \param[in] t1 конец интервала (мкс), включительно.
+	  \param[out] index индекс первого отсчета как в operator[] (от -getSize() до -1, 0 для интервала после последнего отсчета), если не nullptr.
+	  \return участки, первым идет более старый. Пустые, если в буфере нет отсчетов за интервал.
+	*/
+	TFifoSpans<T> query(int64_t t0, int64_t t1, int *index = nullptr)
+	{
+		int64_t first = mTotal - ((mTotal < mSize) ? mTotal : mSize);
+		int64_t c0 = first;
+		int64_t c1 = mTotal;
+		if (mStampCount != 0)
+		{
+			c0 = std::min(std::max(counterAt(t0), first), mTotal);
+			c1 = std::min(counterAt(t1 + 1), mTotal);
+		}
+		if (c1 < c0)
+			c1 = c0;
+		if (index != nullptr)
+			*index = (int)(c0 - mTotal);
+		return this->range((int)(c0 - mTotal), (int)(c1 - c0));
+	}
+
+	/// Количество отсчетов с начала потока.
+	/*!
+	  \return количество.
+	*/
+	inline int64_t getTotal() const { return mTotal; };
+
+	/// Количество меток времени.
+	/*!
+	  \return количество.
+	*/
+	inline int getStampCount() const { return mStampCount; };
+
+	/// Очистка FIFO и меток.
+	void clear()
+	{
+		TFifoArray<T, N, Alloc>::clear();
+		mStamps.clear();
+		mStampCount = 0;
+		mTotal = 0;
+		mLastBlock = {0, 0};
+	}
+};
+
+#endif // TTIMEDFIFO_H
@@ -11,12 +11,14 @@
 #define CBASETASKTEST_H
 
 #include "CBaseTask.h"
+#include "CTaskBalancer.h"
 
 #define BASETASKTEST_QUEUE_BIT 			(31)						///< Номер бита уведомления о сообщении в очереди.
 #define BASETASKTEST_QUEUE_FLAG 		(1 << BASETASKTEST_QUEUE_BIT)	///< Флаг уведомления о сообщении в очереди.
 
 #define MSG_TERMINATE 0
 #define MSG_ECHO 1
+#define MSG_DATA 2
 
 /// Класс для реализации задачи FreeRTOS основной логики работы.
 class CBaseTaskTest : public CBaseTask
@@ -28,29 +30,116 @@ protected:
 public:
     bool mFlag=false;
 
-	/// Послать сообщение в задачу.
+	/// Конструктор.
+	CBaseTaskTest()
+	{
+		mNotify = BASETASKTEST_QUEUE_FLAG;
+	};
+};
+
+/// Задача, которая выбирает очередь только по команде drain().
+class CDrainTaskTest : public CBaseTask
+{
+protected:
+	/// Функция задачи.
+	virtual void run() override;
+
+public:
+	volatile uint32_t mCount = 0; ///< Количество принятых сообщений.
+	volatile uint32_t mSum = 0;	  ///< Сумма байтов тел сообщений MSG_DATA.
+	volatile BaseType_t mCPU = -1; ///< Ядро, на котором принято последнее сообщение.
+
+	/// Конструктор.
 	/*!
-	  \param[in] msg Указатель на сообщение.
-	  \param[in] xTicksToWait Время ожидания в тиках.
-	  \param[in] free вернуть память в кучу в случае неудачи.
-	  \return true в случае успеха.
+	  \param[in] notify Выбирать очередь по каждому сообщению, иначе только по drain().
 	*/
-	inline bool sendMessage(STaskMessage* msg,TickType_t xTicksToWait=0, bool free=false)
+	CDrainTaskTest(bool notify = false)
 	{
-		return CBaseTask::sendMessage(msg, BASETASKTEST_QUEUE_FLAG,xTicksToWait,free);
+		if (notify)
+			mNotify = BASETASKTEST_QUEUE_FLAG;
 	};
 
-	/// Послать сообщение в задачу из прерывания.
+	/// Выбрать все сообщения из очереди.
+	inline void drain() { xTaskNotifyGive(mTaskHandle); };
+};
+
+/// Задача, которая принимает сообщения через getMessage() с ожиданием.
+class CSpinTaskTest : public CBaseTask
+{
+protected:
+	/// Функция задачи.
+	virtual void run() override;
+
+public:
+	volatile uint32_t mCount = 0; ///< Количество принятых сообщений.
+};
+
+/// Задача с периодическим таймером, который ожидается через waitAny().
+class CTimerTaskTest : public CBaseTask
+{
+protected:
+	/// Функция задачи.
+	virtual void run() override;
+
+public:
+	volatile uint32_t mTicks = 0; ///< Количество событий таймера.
+	volatile uint32_t mWaits = 0; ///< Количество возвратов из waitAny().
+
+	/// Конструктор.
+	CTimerTaskTest()
+	{
+		mNotify = BASETASKTEST_QUEUE_FLAG;
+	};
+};
+
+/// Переносимая задача.
+class CMigrateTaskTest : public CBaseTask
+{
+protected:
+	/// Функция задачи.
+	virtual void run() override;
+
+public:
+	using CBaseTask::isMigrating;
+
+	volatile uint32_t mCount = 0;	 ///< Количество принятых сообщений.
+	volatile uint32_t mRuns = 0;	 ///< Количество запусков run().
+	volatile BaseType_t mCPU = -1; ///< Ядро, на котором принято последнее сообщение.
+};
+
+#ifdef CONFIG_TASK_BALANCER
+/// Балансировщик с заданной загрузкой вместо замера.
+class CTaskBalancerTest : public CTaskBalancer
+{
+public:
+	/// Задать параметры решения о переносе.
 	/*!
-	  \param[in] msg Указатель на сообщение.
-	  \param[out] pxHigherPriorityTaskWoken Флаг переключения задач.
-	  \return true в случае успеха.
+	  \param[in] threshold Порог разницы загрузки ядер (%).
+	  \param[in] hysteresis Количество периодов подряд с превышением порога до переноса.
 	*/
-	inline bool sendMessageFromISR(STaskMessage* msg,BaseType_t *pxHigherPriorityTaskWoken) override
+	inline void setup(uint8_t threshold, uint8_t hysteresis) { mState = {threshold, hysteresis, 0, 0}; };
+
+	/// Задать загрузку и выполнить один период балансировки.
+	/*!
+	  \param[in] core0 Загрузка ядра 0 (%).
+	  \param[in] core1 Загрузка ядра 1 (%).
+	  \param[in] taskLoad Загрузка каждой задачи (%).
+	*/
+	void step(uint8_t core0, uint8_t core1, uint8_t taskLoad)
 	{
-		return CBaseTask::sendMessageFromISR(msg,pxHigherPriorityTaskWoken,BASETASKTEST_QUEUE_FLAG);
+		mCoreLoad[0] = core0;
+		mCoreLoad[1] = core1;
+		for (auto &x : m_list)
+			x.load = taskLoad;
+		balance();
 	};
+
+	/// Количество решений.
+	inline uint32_t getDecisionCount() { return mDecisionCount; };
+	/// Последнее решение.
+	inline SBalanceDecision &getDecision() { return mDecisions[-1]; };
 };
+#endif
 /*! @} */
 
 #endif // CBASETASKTEST_H
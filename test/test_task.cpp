@@ -14,6 +14,26 @@
 #include "CDelayTimer.h"
 #include "CTrace.h"
 #include "baseTaskTest.h"
+#include "CMsgArena.h"
+#include "CPhaser.h"
+#include "CBulkRing.h"
+#include "CTaskWatchdog.h"
+#include "CMsgRecorder.h"
+#include "CTaskPool.h"
+#include "CRWLock.h"
+#include "CSpinLock.h"
+#include "TSeqLock.h"
+#include "TFifoArray.h"
+#include "TFifoAllocators.h"
+#include "TSpscFifoArray.h"
+#include "TStatsFifoArray.h"
+#include "TFifoFilter.h"
+#include "TMultiFifoArray.h"
+#include "TTimedFifo.h"
+#include "TTaskRegistry.h"
+#include "esp_timer.h"
+#include <utility>
+#include "esp_memory_utils.h"
 #include "unity_test_utils_memory.h"
 
 #define countof(x) (sizeof(x) / sizeof(x[0]))
@@ -93,31 +113,25 @@ TEST_CASE("CDelayTimer", "[task]")
 
 void CBaseTaskTest::run()
 {
-  uint32_t flags;
-  STaskMessage msg;
+  STaskMessage msg[4];
 #ifdef CONFIG_DEBUG_CODE
   TRACE("Task start", 0, false);
 #endif
 
   for (;;)
   {
-    if (xTaskNotifyWait(0, 0xffffffff, &flags, portMAX_DELAY) == pdTRUE)
+    STaskEvents ev = waitAny(msg, countof(msg));
+    for (uint16_t i = 0; i < ev.count; i++)
     {
-      if ((flags & BASETASKTEST_QUEUE_FLAG) != 0)
+      switch (msg[i].msgID)
       {
-        while (getMessage(&msg))
-        {
-          switch (msg.msgID)
-          {
-          case MSG_ECHO:
-            delete[] msg.msgBody;
-            mFlag = true;
-            break;
-          default:
-            // TRACE("Terminate",0,false);
-            return;
-          }
-        }
+      case MSG_ECHO:
+        freeMsg(msg[i].msgBody);
+        mFlag = true;
+        break;
+      default:
+        // TRACE("Terminate",0,false);
+        return;
       }
     }
   }
@@ -157,3 +171,1346 @@ TEST_CASE("CBaseTask", "[task]")
     TEST_FAIL_MESSAGE("memory leak");
   }
 }
+
+void CTimerTaskTest::run()
+{
+  STaskMessage msg[4];
+  CSoftwareTimer tm(1);
+  tm.start(20, true);
+  for (;;)
+  {
+    STaskEvents ev = waitAny(msg, countof(msg));
+    mWaits++;
+    if (ev.bits & (1 << 1))
+      mTicks++;
+    for (uint16_t i = 0; i < ev.count; i++)
+    {
+      if (msg[i].msgID == MSG_TERMINATE)
+      {
+        tm.stop();
+        return;
+      }
+    }
+  }
+}
+
+/// Тест waitAny() с периодическим таймером: каждое событие таймера приходит один раз.
+TEST_CASE("CBaseTask waitAny timer", "[task]")
+{
+  CTimerTaskTest *tsk = new CTimerTaskTest();
+  tsk->init("timer", 4096, 3, 10, 0);
+  vTaskDelay(pdMS_TO_TICKS(210));
+  uint32_t ticks = tsk->mTicks;
+  uint32_t waits = tsk->mWaits;
+  TRACE("timer ticks", ticks, false);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(9, ticks);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(11, ticks);
+  // Без повторов старого бита задача просыпается только по таймеру.
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(ticks + 1, waits);
+  tsk->sendCmd(MSG_TERMINATE);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_FALSE(tsk->isRun());
+  delete tsk;
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+void CDrainTaskTest::run()
+{
+  STaskMessage msg;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (getMessage(&msg))
+    {
+      if (msg.msgID == MSG_TERMINATE)
+        return;
+      mCPU = xPortGetCoreID();
+      if (msg.msgID == MSG_DATA)
+      {
+        for (uint16_t i = 0; i < msg.shortParam; i++)
+          mSum += ((uint8_t *)msg.msgBody)[i];
+        freeMsg(msg.msgBody);
+      }
+      mCount++;
+    }
+  }
+}
+
+void CSpinTaskTest::run()
+{
+  STaskMessage msg;
+  for (;;)
+  {
+    if (getMessage(&msg, portMAX_DELAY))
+    {
+      if (msg.msgID == MSG_TERMINATE)
+        return;
+      mCount++;
+    }
+  }
+}
+
+/// Тест приема сообщений с активным ожиданием.
+TEST_CASE("CBaseTask spin receive", "[task]")
+{
+  CSpinTaskTest *tsk = new CSpinTaskTest();
+  tsk->init("spin", 4096, 5, 10, 1);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  tsk->setSpinReceive(1000000);
+
+  // Второе сообщение приходит во время активного ожидания после первого.
+  SSpinStats stats;
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  int64_t tm = esp_timer_get_time();
+  while ((esp_timer_get_time() - tm) < 500)
+    ;
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(20));
+  tsk->getSpinStats(&stats);
+  TEST_ASSERT_EQUAL_INT(2, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(0, stats.immediate);
+  TEST_ASSERT_EQUAL_INT(1, stats.spinHits);
+  TEST_ASSERT_EQUAL_INT(1, stats.blocks);
+
+  // Сообщения, накопившиеся в очереди, принимаются без ожидания.
+  vTaskSuspend(tsk->getTask());
+  for (int i = 0; i < 3; i++)
+    TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskResume(tsk->getTask());
+  vTaskDelay(pdMS_TO_TICKS(20));
+  tsk->getSpinStats(&stats);
+  TEST_ASSERT_EQUAL_INT(5, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(2, stats.immediate);
+  TEST_ASSERT_EQUAL_INT(1, stats.spinHits);
+  TEST_ASSERT_EQUAL_INT(2, stats.blocks);
+
+  // Подстроенный бюджет не превышает заданный максимум.
+  tsk->setSpinReceive(1000000, true);
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(20));
+  tsk->getSpinStats(&stats);
+  TEST_ASSERT_EQUAL_INT(6, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(1, stats.blocks);
+  TEST_ASSERT_EQUAL_INT(1000000, stats.budget);
+  tsk->printSpinStats();
+
+  tsk->sendCmd(MSG_TERMINATE);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete tsk;
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+#ifdef CONFIG_TASK_WATCHDOG
+static void onStall(const SWatchdogState *state, void *arg)
+{
+  *(uint32_t *)arg += 1;
+}
+
+/// Тест CTaskWatchdog.
+TEST_CASE("CTaskWatchdog", "[task]")
+{
+  CDrainTaskTest *tsk = new CDrainTaskTest();
+  tsk->init("drain", 4096, 3, 10, 1);
+  vTaskDelay(pdMS_TO_TICKS(10));
+
+  SWatchdogState state;
+  CTaskWatchdog::getState(tsk, &state);
+  TEST_ASSERT_EQUAL_INT(0, state.queued);
+  TEST_ASSERT_EQUAL_INT(0, state.pendingAge);
+
+  uint32_t stalls = 0;
+  CTaskWatchdog *wd = CTaskWatchdog::Instance();
+  uint32_t violations = wd->getViolations();
+  wd->add(tsk, 0, 20000, onStall, &stalls);
+  wd->init(5, 0);
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(50));
+  CTaskWatchdog::getState(tsk, &state);
+  TEST_ASSERT_EQUAL_INT(1, state.queued);
+  TEST_ASSERT_GREATER_OR_EQUAL(40000, state.pendingAge);
+  TEST_ASSERT_EQUAL_INT(1, stalls);
+  TEST_ASSERT_EQUAL_INT(violations + 1, wd->getViolations());
+
+  tsk->drain();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(1, tsk->mCount);
+  CTaskWatchdog::getState(tsk, &state);
+  TEST_ASSERT_EQUAL_INT(0, state.queued);
+  TEST_ASSERT_EQUAL_INT(0, tsk->getPendingSince());
+  TEST_ASSERT_LESS_THAN(20000, esp_timer_get_time() - tsk->getLastDrain());
+
+  // Отправка во время выборки очереди: непустая очередь всегда с меткой, пустая - без нее.
+  STaskMessage msg = {};
+  msg.msgID = MSG_ECHO;
+  for (int i = 0; i < 1000; i++)
+  {
+    TEST_ASSERT_TRUE(tsk->sendMessage(&msg, portMAX_DELAY));
+    tsk->drain();
+  }
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(1001, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(0, tsk->getPendingSince());
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  TEST_ASSERT_LESS_THAN(1000, esp_timer_get_time() - tsk->getPendingSince());
+  tsk->drain();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(1, stalls);
+
+  wd->remove(tsk);
+  wd->sendCmd(MSG_WATCHDOG_STOP);
+  tsk->sendCmd(MSG_TERMINATE);
+  tsk->drain();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete tsk;
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+#endif
+
+#if defined(CONFIG_TASK_RECORDER) && defined(CONFIG_IDF_TARGET_LINUX)
+/// Тест записи и воспроизведения сообщений.
+TEST_CASE("CMsgRecorder", "[task]")
+{
+  // Запись: задача выбирает очередь без ожидания и завершается по записанному MSG_TERMINATE.
+  CDrainTaskTest *tsk = new CDrainTaskTest(true);
+  tsk->init("rec", 4096, 3, 10);
+  CMsgRecorder *rec = new CMsgRecorder();
+  TEST_ASSERT_TRUE(rec->startRecord("test.rec", [](const STaskMessage *msg) -> uint16_t
+                                    { return (msg->msgID == MSG_DATA) ? msg->shortParam : 0; }));
+  tsk->setRecorder(rec);
+  STaskMessage msg;
+  for (int i = 0; i < 10; i++)
+  {
+    uint8_t *body = CBaseTask::allocNewMsg(&msg, MSG_DATA, 4);
+    std::memset(body, i, 4);
+    TEST_ASSERT_TRUE(tsk->sendMessage(&msg, portMAX_DELAY, true));
+    TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO, 0, i));
+  }
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_TERMINATE));
+  vTaskDelay(pdMS_TO_TICKS(50));
+  TEST_ASSERT_FALSE(tsk->isRun());
+  tsk->setRecorder(nullptr);
+  TEST_ASSERT_EQUAL_INT(21, rec->stopRecord());
+  TEST_ASSERT_EQUAL_INT(20, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(180, tsk->mSum);
+  delete tsk;
+
+  // Воспроизведение заканчивается на последнем сообщении, после которого задача уже не ждет сообщений.
+  tsk = new CDrainTaskTest(true);
+  tsk->init("replay", 4096, 3, 10);
+  TEST_ASSERT_TRUE(rec->replay("test.rec", tsk, false, pdMS_TO_TICKS(1000)));
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_FALSE(tsk->isRun());
+  TEST_ASSERT_EQUAL_INT(20, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(180, tsk->mSum);
+  SReplayStats stats;
+  rec->getStats(&stats);
+  TEST_ASSERT_EQUAL_INT(21, stats.messages);
+  TEST_ASSERT_EQUAL_INT(40, stats.bytes);
+  rec->printStats();
+  delete tsk;
+  delete rec;
+  std::remove("test.rec");
+}
+#endif
+
+void CMigrateTaskTest::run()
+{
+  STaskMessage msg;
+  mRuns++;
+  for (;;)
+  {
+    if (getMessage(&msg, portMAX_DELAY))
+    {
+      if (msg.msgID == MSG_TERMINATE)
+        return;
+      mCPU = xPortGetCoreID();
+      mCount++;
+    }
+    // Без xTaskAbortDelay перенос выполняется после следующего сообщения.
+    if (isMigrating())
+      return;
+  }
+}
+
+/// Тест переноса задачи на другое ядро.
+TEST_CASE("CBaseTask migrate", "[task]")
+{
+  CMigrateTaskTest *tsk = new CMigrateTaskTest();
+  tsk->init("migrate", 4096, 3, 10, 0);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_FALSE(tsk->migrate(1));
+  tsk->setMigratable();
+  TEST_ASSERT_FALSE(tsk->migrate(0));
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(0, tsk->mCPU);
+
+  TaskHandle_t handle = tsk->getTask();
+  TEST_ASSERT_TRUE(tsk->migrate(1));
+  // Сообщение, отправленное во время переноса, остается в очереди.
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(20));
+  TEST_ASSERT_FALSE(tsk->isMigrating());
+  TEST_ASSERT_EQUAL_INT(1, tsk->getCore());
+  TEST_ASSERT_TRUE(tsk->sendCmd(MSG_ECHO));
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(3, tsk->mCount);
+  TEST_ASSERT_EQUAL_INT(1, tsk->mCPU);
+#if (configUSE_CORE_AFFINITY == 1)
+  TEST_ASSERT_EQUAL_INT(1, tsk->mRuns);
+  TEST_ASSERT_EQUAL_PTR(handle, tsk->getTask());
+#else
+  // Задача пересоздана на новом ядре с той же очередью.
+  TEST_ASSERT_EQUAL_INT(2, tsk->mRuns);
+  TEST_ASSERT_TRUE(handle != tsk->getTask());
+  TEST_ASSERT_TRUE(tsk->isRun());
+#endif
+  tsk->sendCmd(MSG_TERMINATE);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_FALSE(tsk->isRun());
+  delete tsk;
+
+#if (configUSE_CORE_AFFINITY != 1)
+  // Задачу со статическим стеком пересоздать нельзя.
+  static StackType_t stack[4096];
+  static StaticTask_t tcb;
+  static uint8_t queueBuffer[4 * sizeof(STaskMessage)];
+  static StaticQueue_t queue;
+  tsk = new CMigrateTaskTest();
+  tsk->init("migrate", 4096, 3, 4, stack, &tcb, queueBuffer, &queue, 0);
+  tsk->setMigratable();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_FALSE(tsk->migrate(1));
+  TEST_ASSERT_FALSE(tsk->isMigrating());
+  tsk->sendCmd(MSG_TERMINATE);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete tsk;
+#endif
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+#ifdef CONFIG_TASK_BALANCER
+/// Тест решения CTaskBalancer на заданной загрузке.
+TEST_CASE("CTaskBalancer decide", "[task]")
+{
+  TEST_ASSERT_EQUAL_INT(25, CTaskBalancer::percent(50, 200));
+  TEST_ASSERT_EQUAL_INT(0, CTaskBalancer::percent(0, 200));
+  TEST_ASSERT_EQUAL_INT(100, CTaskBalancer::percent(300, 200));
+
+  const uint8_t coreLoad[2] = {80, 30};
+  const SBalanceLoad tasks[] = {
+      {0, 10, true},
+      {0, 30, true},  // 80 - 30 = 50: ближе всего к половине разницы
+      {0, 25, false}, // не переносится
+      {1, 25, true},  // на менее загруженном ядре
+      {0, 0, true},   // без загрузки
+      {0, 60, true},  // больше разницы
+  };
+  SBalanceState state = {20, 3, 0, 0};
+  BaseType_t from = -1;
+  BaseType_t to = -1;
+  // Перенос после hysteresis периодов подряд.
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(0, from);
+  TEST_ASSERT_EQUAL_INT(1, to);
+  TEST_ASSERT_EQUAL_INT(0, state.imbalance);
+  TEST_ASSERT_EQUAL_INT(3, state.cooldown);
+
+  // Пауза после решения.
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+
+  // Разница не больше порога сбрасывает счетчик периодов.
+  const uint8_t balanced[2] = {50, 30};
+  state = {20, 3, 0, 0};
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, balanced, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(0, state.imbalance);
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+  TEST_ASSERT_EQUAL_INT(1, CTaskBalancer::decide(state, coreLoad, tasks, countof(tasks), from, to));
+
+  // Перегружено ядро 1: задачи ядра 0 не подходят, без кандидата решение откладывается до первого подходящего периода.
+  const uint8_t reversed[2] = {30, 80};
+  const SBalanceLoad none[] = {{0, 25, true}, {1, 60, true}};
+  state = {20, 1, 0, 0};
+  TEST_ASSERT_EQUAL_INT(-1, CTaskBalancer::decide(state, reversed, none, countof(none), from, to));
+  TEST_ASSERT_EQUAL_INT(1, from);
+  TEST_ASSERT_EQUAL_INT(0, to);
+  TEST_ASSERT_EQUAL_INT(1, state.imbalance);
+  TEST_ASSERT_EQUAL_INT(0, state.cooldown);
+  TEST_ASSERT_EQUAL_INT(0, CTaskBalancer::decide(state, reversed, tasks + 3, 1, from, to));
+}
+
+/// Тест переноса задачи и журнала решений CTaskBalancer.
+TEST_CASE("CTaskBalancer balance", "[task]")
+{
+  CMigrateTaskTest *tsk = new CMigrateTaskTest();
+  tsk->init("balanced", 4096, 3, 10, 0);
+  tsk->setMigratable();
+  CTaskBalancerTest *balancer = new CTaskBalancerTest();
+  balancer->setup(20, 2);
+  balancer->add(tsk);
+  vTaskDelay(pdMS_TO_TICKS(10));
+
+  balancer->step(80, 30, 25);
+  TEST_ASSERT_EQUAL_INT(0, balancer->getDecisionCount());
+  balancer->step(80, 30, 25);
+  TEST_ASSERT_EQUAL_INT(1, balancer->getDecisionCount());
+  SBalanceDecision &d = balancer->getDecision();
+  TEST_ASSERT_EQUAL_STRING("balanced", d.name);
+  TEST_ASSERT_EQUAL_INT(0, d.from);
+  TEST_ASSERT_EQUAL_INT(1, d.to);
+  TEST_ASSERT_EQUAL_INT(25, d.taskLoad);
+  TEST_ASSERT_EQUAL_INT(80, d.coreLoad[0]);
+  TEST_ASSERT_EQUAL_INT(30, d.coreLoad[1]);
+  balancer->printLog();
+
+  tsk->sendCmd(MSG_ECHO);
+  vTaskDelay(pdMS_TO_TICKS(20));
+  TEST_ASSERT_EQUAL_INT(1, tsk->getCore());
+  TEST_ASSERT_EQUAL_INT(1, tsk->mCPU);
+
+  // Задача уже на менее загруженном ядре.
+  for (int i = 0; i < 4; i++)
+    balancer->step(80, 30, 25);
+  TEST_ASSERT_EQUAL_INT(1, balancer->getDecisionCount());
+
+  balancer->remove(tsk);
+  delete balancer;
+  tsk->sendCmd(MSG_TERMINATE);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete tsk;
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+#endif
+
+constexpr STaskConfig cfgRegA = {"regA", 3072, 5, 4, 0};
+constexpr STaskConfig cfgRegB = {"regB", 3072, 5, 6, 1};
+constexpr STaskConfig cfgRegC = {"regC", 2048, 5, 5, tskNO_AFFINITY};
+using TRegA = TTaskEntry<CDrainTaskTest, cfgRegA>;
+using TRegB = TTaskEntry<CDrainTaskTest, cfgRegB>;
+using TRegC = TTaskEntry<CDrainTaskTest, cfgRegC>;
+using TRegTasks = TTaskRegistry<8192, TRegA, TRegB, TRegC>;
+
+static_assert(TRegTasks::count == 3);
+static_assert(TRegTasks::getStack(0) == 3072 + 2048);
+
+/// Проверка задачи из таблицы: длина очереди и ядро.
+/*!
+  \param[in] tsk Задача.
+  \param[in] config Параметры задачи.
+*/
+static void checkRegistryTask(CDrainTaskTest *tsk, const STaskConfig &config)
+{
+  TEST_ASSERT_NOT_NULL(tsk);
+  TEST_ASSERT_TRUE(tsk->isRun());
+  TEST_ASSERT_EQUAL_STRING(config.name, pcTaskGetName(tsk->getTask()));
+  UBaseType_t n = 0;
+  while (tsk->sendCmd(MSG_ECHO))
+    n++;
+  TEST_ASSERT_EQUAL_INT(config.queueLength, n);
+  tsk->drain();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(n, tsk->mCount);
+  if (config.coreID != tskNO_AFFINITY)
+    TEST_ASSERT_EQUAL_INT(config.coreID, tsk->mCPU);
+}
+
+/// Тест TTaskRegistry.
+TEST_CASE("TTaskRegistry", "[task]")
+{
+  uint32_t mem1 = esp_get_free_heap_size();
+
+  TEST_ASSERT_NULL(TRegA::instance());
+  TRegTasks::start();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  // Объекты задач размещены в статической памяти.
+  TEST_ASSERT_TRUE(esp_ptr_in_dram(TRegA::instance()));
+  TEST_ASSERT_EQUAL_INT(mem1, esp_get_free_heap_size());
+
+  checkRegistryTask(TRegA::instance(), cfgRegA);
+  checkRegistryTask(TRegB::instance(), cfgRegB);
+  checkRegistryTask(TRegC::instance(), cfgRegC);
+
+  STaskMessage msg;
+  uint8_t *data = CBaseTask::allocNewMsg(&msg, MSG_DATA, 4);
+  TEST_ASSERT_NOT_NULL(data);
+  for (int i = 0; i < 4; i++)
+    data[i] = i + 1;
+  TEST_ASSERT_TRUE(TRegB::instance()->sendMessage(&msg, 0, true));
+  TRegB::instance()->drain();
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(10, TRegB::instance()->mSum);
+
+  // Завершение задач не должно возвращать статическую память в кучу.
+  TRegA::instance()->sendCmd(MSG_TERMINATE);
+  TRegA::instance()->drain();
+  TRegB::instance()->sendCmd(MSG_TERMINATE);
+  TRegB::instance()->drain();
+  TRegC::instance()->sendCmd(MSG_TERMINATE);
+  TRegC::instance()->drain();
+  vTaskDelay(pdMS_TO_TICKS(20));
+  TEST_ASSERT_FALSE(TRegA::instance()->isRun());
+  TEST_ASSERT_FALSE(TRegB::instance()->isRun());
+  TEST_ASSERT_FALSE(TRegC::instance()->isRun());
+
+  uint32_t mem2 = esp_get_free_heap_size();
+  if (mem1 != mem2)
+  {
+    TRACE("start", mem1, false);
+    TRACE("stop", mem2, false);
+    TEST_FAIL_MESSAGE("heap changed");
+  }
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+  heap_caps_check_integrity_all(true);
+#endif
+}
+
+/// Тест CMsgArena.
+TEST_CASE("CMsgArena", "[task]")
+{
+  unity_utils_record_free_mem();
+
+  CMsgArena *arena = new CMsgArena(256, 2);
+  STaskMessage msg;
+  uint8_t *p1 = CBaseTask::allocNewMsg(&msg, MSG_ECHO, 100, arena);
+  TEST_ASSERT_NOT_NULL(p1);
+  TEST_ASSERT_EQUAL_INT(100, msg.shortParam);
+  uint8_t *p2 = CBaseTask::allocNewMsg(&msg, MSG_ECHO, 100, arena);
+  TEST_ASSERT_EQUAL_PTR(p1 + 100, p2);
+  TEST_ASSERT_NULL(CBaseTask::allocNewMsg(&msg, MSG_ECHO, 100, arena));
+  TEST_ASSERT_EQUAL_INT(1, arena->getFailed());
+  CBaseTask::freeMsg(p1);
+
+  TEST_ASSERT_TRUE(arena->nextEpoch());
+  TEST_ASSERT_EQUAL_INT(1, arena->getEpoch());
+  TEST_ASSERT_NOT_NULL(CBaseTask::allocNewMsg(&msg, MSG_ECHO, 200, arena));
+  TEST_ASSERT_FALSE(arena->nextEpoch());
+  arena->ack(0);
+  TEST_ASSERT_FALSE(arena->nextEpoch());
+  arena->ack(0);
+  TEST_ASSERT_TRUE(arena->nextEpoch());
+  TEST_ASSERT_EQUAL_PTR(p1, CBaseTask::allocNewMsg(&msg, MSG_ECHO, 16, arena));
+  TEST_ASSERT_EQUAL_INT(200, arena->getPeak());
+  delete arena;
+
+  unity_utils_evaluate_leaks_direct(0);
+}
+
+static void barrierTask(void *pvParameters)
+{
+  CBarrier *barrier = (CBarrier *)pvParameters;
+  for (int i = 0; i < 10; i++)
+  {
+    barrier->wait(pdMS_TO_TICKS(100));
+  }
+  vTaskDelete(nullptr);
+}
+
+/// Тест CBarrier.
+TEST_CASE("CBarrier", "[task]")
+{
+  CBarrier *barrier = new CBarrier(3);
+  xTaskCreatePinnedToCore(barrierTask, "b0", 2048, barrier, 5, nullptr, 0);
+  xTaskCreatePinnedToCore(barrierTask, "b1", 2048, barrier, 5, nullptr, 1);
+  for (int i = 0; i < 10; i++)
+  {
+    TEST_ASSERT_TRUE(barrier->wait(pdMS_TO_TICKS(100)));
+  }
+  TEST_ASSERT_EQUAL_INT(10, barrier->getPhase());
+  vTaskDelay(pdMS_TO_TICKS(10));
+
+  SPhaserStats stats;
+  barrier->getStats(&stats);
+  TEST_ASSERT_EQUAL_INT(10, stats.phases);
+  TEST_ASSERT_EQUAL_INT(30, stats.waits);
+  TEST_ASSERT_EQUAL_INT(0, stats.timeouts);
+  TRACE("barrier spin hits", stats.spinHits, false);
+  TRACE("barrier max wait", (int32_t)stats.maxWait, false);
+  delete barrier;
+}
+
+/// Параметры задачи теста CPhaser.
+struct SPhaserTaskParam
+{
+  CPhaser *phaser; ///< Синхронизация фаз.
+  int phases;      ///< Количество фаз до выхода.
+};
+
+static void phaserTask(void *pvParameters)
+{
+  SPhaserTaskParam *param = (SPhaserTaskParam *)pvParameters;
+  for (int i = 0; i < param->phases; i++)
+  {
+    param->phaser->arriveAndWait(pdMS_TO_TICKS(100));
+  }
+  param->phaser->arriveAndDeregister();
+  vTaskDelete(nullptr);
+}
+
+/// Тест выхода участников CPhaser.
+TEST_CASE("CPhaser deregister", "[task]")
+{
+  CPhaser *phaser = new CPhaser(3);
+  SPhaserTaskParam p0 = {phaser, 5};
+  SPhaserTaskParam p1 = {phaser, 10};
+  xTaskCreatePinnedToCore(phaserTask, "p0", 2048, &p0, 5, nullptr, 0);
+  xTaskCreatePinnedToCore(phaserTask, "p1", 2048, &p1, 5, nullptr, 1);
+  for (int i = 0; i < 15; i++)
+  {
+    TEST_ASSERT_TRUE(phaser->arriveAndWait(pdMS_TO_TICKS(100)));
+    TEST_ASSERT_EQUAL_INT(i + 1, phaser->getPhase());
+  }
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(1, phaser->getParties());
+
+  // Новый участник входит в текущую фазу, выход последнего из двух завершает ее.
+  TEST_ASSERT_EQUAL_INT(15, phaser->registerParty());
+  TEST_ASSERT_EQUAL_INT(15, phaser->arrive());
+  TEST_ASSERT_EQUAL_INT(15, phaser->getPhase());
+  TEST_ASSERT_EQUAL_INT(15, phaser->arriveAndDeregister());
+  TEST_ASSERT_EQUAL_INT(16, phaser->getPhase());
+  TEST_ASSERT_EQUAL_INT(1, phaser->getParties());
+  TEST_ASSERT_TRUE(phaser->awaitAdvance(15, 0));
+
+  SPhaserStats stats;
+  phaser->getStats(&stats);
+  TEST_ASSERT_EQUAL_INT(16, stats.phases);
+  TEST_ASSERT_EQUAL_INT(0, stats.timeouts);
+  delete phaser;
+}
+
+/// Тест CBulkRing.
+TEST_CASE("CBulkRing", "[task]")
+{
+  unity_utils_record_free_mem();
+
+  CBulkRing *ring = new CBulkRing(100, 2);
+  TEST_ASSERT_EQUAL_INT(128, ring->getSlotSize());
+  TEST_ASSERT_NULL(ring->front());
+  uint8_t *p1 = ring->acquire();
+  TEST_ASSERT_NOT_NULL(p1);
+  TEST_ASSERT_EQUAL_INT(0, (uintptr_t)p1 % BULKRING_ALIGN);
+  std::memset(p1, 1, 100);
+  TEST_ASSERT_EQUAL_INT(0, ring->commit(100));
+  uint8_t *p2 = ring->acquire();
+  TEST_ASSERT_EQUAL_PTR(p1 + 128, p2);
+  TEST_ASSERT_EQUAL_INT(1, ring->commit(50));
+  TEST_ASSERT_NULL(ring->acquire());
+  TEST_ASSERT_EQUAL_INT(1, ring->getFull());
+
+  uint32_t size;
+  TEST_ASSERT_EQUAL_PTR(p1, ring->front(&size));
+  TEST_ASSERT_EQUAL_INT(100, size);
+  TEST_ASSERT_EQUAL_INT(1, p1[99]);
+  ring->release();
+  TEST_ASSERT_EQUAL_PTR(p1, ring->acquire(pdMS_TO_TICKS(10)));
+  TEST_ASSERT_EQUAL_PTR(p2, ring->front(&size));
+  TEST_ASSERT_EQUAL_INT(50, size);
+  ring->release();
+  TEST_ASSERT_NULL(ring->front());
+  TEST_ASSERT_EQUAL_INT(2, ring->getPeak());
+  delete ring;
+
+  // Количество слотов не степень двойки: несколько оборотов кольца.
+  ring = new CBulkRing(16, 3);
+  uint8_t *base = ring->acquire();
+  for (int i = 0; i < 20; i++)
+  {
+    uint8_t *p = (i == 0) ? base : ring->acquire();
+    TEST_ASSERT_EQUAL_PTR(base + (i % 3) * ring->getSlotSize(), p);
+    p[0] = i;
+    ring->commit(1 + (i % 3));
+    if (i >= 1)
+    {
+      uint8_t *f = ring->front(&size);
+      TEST_ASSERT_EQUAL_INT(i - 1, f[0]);
+      TEST_ASSERT_EQUAL_INT(1 + ((i - 1) % 3), size);
+      ring->release();
+    }
+    TEST_ASSERT_EQUAL_INT(1, ring->getCount());
+  }
+  delete ring;
+
+  unity_utils_evaluate_leaks_direct(0);
+}
+
+static void poolJob(CPoolTask *task, void *arg)
+{
+  STaskMessage msg;
+  if (task->getMessage(&msg, pdMS_TO_TICKS(100)))
+    *(uint32_t *)arg += msg.paramID;
+}
+
+/// Тест CTaskPool.
+TEST_CASE("CTaskPool", "[task]")
+{
+  CTaskPool *pool = new CTaskPool();
+  pool->init("pool", 2, 2048, 5, 4);
+  uint32_t a = 0;
+  uint32_t b = 0;
+  CPoolTask *t1 = pool->start(poolJob, &a);
+  CPoolTask *t2 = pool->start(poolJob, &b);
+  TEST_ASSERT_NOT_NULL(t1);
+  TEST_ASSERT_NOT_NULL(t2);
+  TEST_ASSERT_NULL(pool->start(poolJob, &a));
+  t1->sendCmd(MSG_ECHO, 0, 10);
+  t2->sendCmd(MSG_ECHO, 0, 20);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(10, a);
+  TEST_ASSERT_EQUAL_INT(20, b);
+
+  CPoolTask *t3 = pool->start(poolJob, &a, pdMS_TO_TICKS(10));
+  TEST_ASSERT_NOT_NULL(t3);
+  t3->sendCmd(MSG_ECHO, 0, 5);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_EQUAL_INT(15, a);
+
+  SPoolStats stats;
+  pool->getStats(&stats);
+  TEST_ASSERT_EQUAL_INT(2, stats.idle);
+  TEST_ASSERT_EQUAL_INT(2, stats.peakBusy);
+  TEST_ASSERT_EQUAL_INT(3, stats.started);
+  TEST_ASSERT_EQUAL_INT(1, stats.failed);
+  delete pool;
+  vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+#ifdef CONFIG_DEBUG_CODE
+/// Трассировщик для подсчета вызовов startTime().
+class CCountLog : public ITraceLog
+{
+public:
+  volatile uint32_t mCount = 0; ///< Количество вызовов.
+
+  void trace(const char *strError, int32_t errCode, esp_log_level_t level, bool reboot) override {};
+  void trace(const char *strError, uint8_t *data, uint32_t size) override {};
+  void trace(const char *strError, uint16_t *data, uint32_t size) override {};
+  void trace(const char *strError, uint32_t *data, uint32_t size) override {};
+  void startTime() override { mCount++; };
+};
+
+static volatile bool traceRun;
+
+static void traceTask(void *pvParameters)
+{
+  uint32_t n = 0;
+  while (traceRun)
+  {
+    traceLog.startTime();
+    if ((++n & 0xff) == 0)
+      vTaskDelay(1);
+  }
+  vTaskDelete(nullptr);
+}
+
+/// Тест CTraceList: непрерывный вывод из двух ядер во время add() и remove().
+TEST_CASE("CTraceList", "[task]")
+{
+  CCountLog *keep = new CCountLog();
+  ADDLOG(keep);
+  traceRun = true;
+  xTaskCreatePinnedToCore(traceTask, "tr0", 2048, nullptr, 1, nullptr, 0);
+  xTaskCreatePinnedToCore(traceTask, "tr1", 2048, nullptr, 1, nullptr, 1);
+  vTaskDelay(pdMS_TO_TICKS(10));
+
+  int64_t tm = esp_timer_get_time();
+  for (int i = 0; i < 100; i++)
+  {
+    CCountLog *log = new CCountLog();
+    ADDLOG(log);
+    vTaskDelay(1);
+    REMOVELOG(log);
+    delete log;
+  }
+  tm = esp_timer_get_time() - tm;
+  TRACE("add/remove time", (int32_t)tm, false);
+  TEST_ASSERT_LESS_THAN(2000000, tm);
+
+  traceRun = false;
+  vTaskDelay(pdMS_TO_TICKS(10));
+  REMOVELOG(keep);
+  TEST_ASSERT_GREATER_THAN(0, keep->mCount);
+  delete keep;
+}
+#endif
+
+/// Класс для тестирования CLock.
+class CLockTest : public CLock
+{
+public:
+  CLockTest() : CLock("test") { CLock::init(xSemaphoreCreateMutex()); };
+  ~CLockTest() { vSemaphoreDelete(mMutex); };
+
+  bool guarded()
+  {
+    TLockGuard<CLock> guard(*this);
+    return tryLock(0);
+  };
+  bool free()
+  {
+    if (!tryLock(0))
+      return false;
+    unlock();
+    return true;
+  };
+};
+
+/// Тест CLock.
+TEST_CASE("CLock", "[task]")
+{
+  CLockTest *lock = new CLockTest();
+  TEST_ASSERT_FALSE(lock->guarded());
+  TEST_ASSERT_TRUE(lock->free());
+#ifdef CONFIG_LOCK_STATISTICS
+  SLockStats stats;
+  lock->getStats(&stats);
+  TEST_ASSERT_EQUAL_INT(2, stats.count);
+  TEST_ASSERT_EQUAL_INT(0, stats.contended);
+  CLock::printStats();
+#endif
+  delete lock;
+}
+
+/// Класс для тестирования CRWLock.
+class CRWLockTest : public CRWLock
+{
+public:
+  using CRWLock::lockShared;
+  using CRWLock::tryLock;
+  using CRWLock::tryLockShared;
+  using CRWLock::unlock;
+  using CRWLock::unlockShared;
+};
+
+/// Тест CRWLock.
+TEST_CASE("CRWLock", "[task]")
+{
+  CRWLockTest *lock = new CRWLockTest();
+  lock->lockShared();
+  TEST_ASSERT_TRUE(lock->tryLockShared(0));
+  TEST_ASSERT_FALSE(lock->tryLock(pdMS_TO_TICKS(10)));
+  TEST_ASSERT_TRUE(lock->tryLockShared(0));
+  lock->unlockShared();
+  lock->unlockShared();
+  lock->unlockShared();
+
+  TEST_ASSERT_TRUE(lock->tryLock(0));
+  TEST_ASSERT_FALSE(lock->tryLockShared(pdMS_TO_TICKS(10)));
+  lock->unlock();
+  {
+    TSharedLockGuard<CRWLockTest> guard(*lock);
+    TEST_ASSERT_FALSE(lock->tryLock(0));
+  }
+  TEST_ASSERT_TRUE(lock->tryLock(0));
+  lock->unlock();
+  delete lock;
+}
+
+/// Класс для тестирования CSpinLock.
+class CSpinLockTest : public CSpinLock
+{
+public:
+  bool guarded()
+  {
+    TLockGuard<CSpinLock> guard(*this);
+    return tryLock();
+  };
+  bool free()
+  {
+    if (!tryLock())
+      return false;
+    unlock();
+    return true;
+  };
+};
+
+/// Тест CSpinLock.
+TEST_CASE("CSpinLock", "[task]")
+{
+  CSpinLockTest lock;
+  TEST_ASSERT_FALSE(lock.guarded());
+  TEST_ASSERT_TRUE(lock.free());
+}
+
+/// Данные для тестирования TSeqLock.
+struct SSeqTest
+{
+  uint32_t a;
+  uint32_t b;
+};
+
+static void seqWriter(void *pvParameters)
+{
+  TSeqLock<SSeqTest> *seq = (TSeqLock<SSeqTest> *)pvParameters;
+  for (uint32_t i = 1; i <= 10000; i++)
+  {
+    seq->write({i, ~i});
+  }
+  vTaskDelete(nullptr);
+}
+
+/// Тест TSeqLock.
+TEST_CASE("TSeqLock", "[task]")
+{
+  TSeqLock<SSeqTest> *seq = new TSeqLock<SSeqTest>({0, ~0u});
+  SSeqTest data;
+  TEST_ASSERT_EQUAL_INT(0, seq->read(&data));
+  xTaskCreatePinnedToCore(seqWriter, "seq", 2048, seq, 5, nullptr, 1);
+  do
+  {
+    seq->read(&data);
+    TEST_ASSERT_EQUAL_UINT32(~data.a, data.b);
+  } while (data.a != 10000);
+  TEST_ASSERT_EQUAL_INT(10000, seq->getVersion());
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete seq;
+}
+
+/// Тест TFifoArray.
+TEST_CASE("TFifoArray", "[task]")
+{
+  TFifoArray<int, 8> fifo;
+  TFifoArray<int> heapFifo(8);
+  TFifoArray<int, 6> fifo6;
+  TEST_ASSERT_EQUAL_INT(8, fifo.getSize());
+  for (int i = 0; i < 11; i++)
+  {
+    fifo.push(i);
+    heapFifo.push(i);
+    fifo6.push(i);
+  }
+  TEST_ASSERT_EQUAL_INT(10, fifo[-1]);
+  TEST_ASSERT_EQUAL_INT(3, fifo[0]);
+  TEST_ASSERT_EQUAL_INT(10, fifo[15]);
+  TEST_ASSERT_EQUAL_INT(heapFifo[-3], fifo[-3]);
+  TEST_ASSERT_EQUAL_INT(10, fifo6[-1]);
+  TEST_ASSERT_EQUAL_INT(5, fifo6[0]);
+
+  TFifoSpans<int> spans = fifo.spans();
+  TEST_ASSERT_EQUAL_INT(5, spans.firstSize);
+  TEST_ASSERT_EQUAL_INT(3, spans.first[0]);
+  TEST_ASSERT_EQUAL_INT(3, spans.secondSize);
+  TEST_ASSERT_EQUAL_INT(10, spans.second[2]);
+  spans = fifo.spans(2);
+  TEST_ASSERT_EQUAL_INT(2, spans.firstSize);
+  TEST_ASSERT_EQUAL_INT(0, spans.secondSize);
+  int *data = fifo.align();
+  for (int i = 0; i < 8; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(i + 3, data[i]);
+  }
+  TEST_ASSERT_EQUAL_INT(10, fifo[-1]);
+
+  int buf[16] = {};
+  fifo.read(buf, 5, 1);
+  TEST_ASSERT_EQUAL_INT(4, buf[0]);
+  TEST_ASSERT_EQUAL_INT(8, buf[4]);
+  fifo.read(buf, 8, 0, 2);
+  TEST_ASSERT_EQUAL_INT(3, buf[0]);
+  TEST_ASSERT_EQUAL_INT(10, buf[14]);
+  TEST_ASSERT_EQUAL_INT(8, fifo.getUnread());
+  TEST_ASSERT_EQUAL_INT(3, fifo.pop(buf, 3));
+  TEST_ASSERT_EQUAL_INT(5, buf[2]);
+  TFifoArray<int> dst(4);
+  TEST_ASSERT_EQUAL_INT(5, fifo.pop(dst, 10));
+  TEST_ASSERT_EQUAL_INT(7, dst[0]);
+  TEST_ASSERT_EQUAL_INT(10, dst[-1]);
+  TEST_ASSERT_EQUAL_INT(0, fifo.pop(buf, 3));
+
+  unity_utils_record_free_mem();
+  {
+    TFifoArray<int, 0, TInternalAllocator> internal(8);
+    internal.push(buf, 8);
+    TFifoArray<int, 0, TInternalAllocator> moved(std::move(internal));
+    TEST_ASSERT_EQUAL_INT(8, moved.getSize());
+    TEST_ASSERT_EQUAL_INT(buf[7], moved[-1]);
+    TFifoArray<uint8_t, 0, TDmaAllocator> dma(64);
+    TEST_ASSERT_TRUE(esp_ptr_dma_capable(dma.align()));
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)dma.align() % 4);
+  }
+  unity_utils_evaluate_leaks_direct(0);
+}
+
+/// Тест TStatsFifoArray.
+TEST_CASE("TStatsFifoArray", "[task]")
+{
+  // Для N > 0 буфер и очереди минимума и максимума внутри объекта, без кучи.
+  uint32_t mem = esp_get_free_heap_size();
+  TStatsFifoArray<int16_t, 4> stats;
+  TEST_ASSERT_EQUAL_INT(mem, esp_get_free_heap_size());
+  int16_t data[6] = {5, -3, 8, 1, 2, 4};
+  stats.push(data, 3);
+  TEST_ASSERT_EQUAL_INT(3, stats.getCount());
+  TEST_ASSERT_EQUAL_INT(-3, stats.getMin());
+  TEST_ASSERT_EQUAL_INT(8, stats.getMax());
+  stats.push(&data[3], 3);
+  TEST_ASSERT_EQUAL_INT(4, stats.getCount());
+  TEST_ASSERT_EQUAL_INT(1, stats.getMin());
+  TEST_ASSERT_EQUAL_INT(8, stats.getMax());
+  TEST_ASSERT_EQUAL_INT(7, stats.getPeakToPeak());
+  TEST_ASSERT_EQUAL_INT(15, stats.getSum());
+  stats.push(data, 6);
+  TEST_ASSERT_EQUAL_INT(1, stats.getMin());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.75f, stats.getMean());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.6098f, stats.getRms());
+
+  TStatsFifoArray<float> fstats(3);
+  fstats.push(3.0f);
+  fstats.push(-4.0f);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.5355f, fstats.getRms());
+  TEST_ASSERT_EQUAL_FLOAT(-4.0f, fstats.getMin());
+  fstats.clear();
+  TEST_ASSERT_EQUAL_INT(0, fstats.getCount());
+
+  TStatsFifoArray<int16_t, 0, int64_t, TInternalAllocator> internal(16);
+  internal.push(data, 6);
+  TEST_ASSERT_EQUAL_INT(8, internal.getMax());
+  TEST_ASSERT_EQUAL_INT(17, internal.getSum());
+}
+
+/// Коэффициенты КИХ фильтра, заданные при компиляции.
+static constexpr std::array<float, 32> firCoeffs = []()
+{
+  std::array<float, 32> c = {};
+  for (int i = 0; i < 32; i++)
+    c[i] = 0.01f * (i + 1);
+  return c;
+}();
+
+/// Тест и сравнение скорости фильтров над TFifoArray.
+TEST_CASE("TFifoFilter", "[task]")
+{
+  static float coeffs[32];
+  for (int i = 0; i < 32; i++)
+    coeffs[i] = 0.01f * (i + 1);
+
+  TFirFilter<float, 32> *fir = new TFirFilter<float, 32>(coeffs);
+  TFirDecimator<float, 32, 4> *dec = new TFirDecimator<float, 32, 4>(coeffs);
+  TFixedFirFilter<float, firCoeffs> *fixed = new TFixedFirFilter<float, firCoeffs>();
+  TFifoArray<float, 32> *naive = new TFifoArray<float, 32>();
+  naive->clear();
+  float *in = new float[1024];
+  float *out = new float[1024];
+  float *outDec = new float[256];
+  float *outFixed = new float[1024];
+  for (int i = 0; i < 1024; i++)
+    in[i] = (float)(i % 7);
+
+  fir->process(in, out, 1024);
+  fixed->process(in, outFixed, 1024);
+  TEST_ASSERT_EQUAL_INT(256, dec->process(in, outDec, 1024));
+  for (int i = 0; i < 1024; i++)
+  {
+    naive->push(in[i]);
+    float *x = naive->align();
+    float y = 0;
+    for (int k = 0; k < 32; k++)
+      y += x[k] * coeffs[k];
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, y, out[i]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, y, outFixed[i]);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, out[1023], (TFixedFirFilter<float, firCoeffs>::apply(*naive)));
+  for (int i = 0; i < 256; i++)
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, out[4 * i + 3], outDec[i]);
+
+  // Количество коэффициентов не кратно коэффициенту децимации: последний подфильтр дополнен нулями.
+  TFirFilter<float, 30> fir30(coeffs);
+  TFirDecimator<float, 30, 4> dec30(coeffs);
+  for (int i = 0; i < 200; i++)
+  {
+    float y30 = fir30.process(in[i]);
+    float yDec;
+    if (dec30.process(in[i], yDec))
+      TEST_ASSERT_FLOAT_WITHIN(0.001f, y30, yDec);
+    else
+      TEST_ASSERT_NOT_EQUAL(3, i % 4);
+  }
+
+  float y;
+  TEST_ASSERT_FALSE(dec->process(1.0f, y));
+  TEST_ASSERT_FALSE(dec->process(1.0f, y));
+  TEST_ASSERT_FALSE(dec->process(1.0f, y));
+  TEST_ASSERT_TRUE(dec->process(1.0f, y));
+
+  // Два звена с обратной связью против разностного уравнения y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2].
+  static const SBiquad sections[2] = {{0.2f, 0.3f, 0.1f, -0.6f, 0.2f}, {0.5f, -0.2f, 0.4f, 0.3f, 0.1f}};
+  TBiquadFilter<float, 2> iir(sections);
+  float x1[3] = {}, y1[3] = {}, y2[3] = {};
+  for (int i = 0; i < 200; i++)
+  {
+    float x = (float)((i * 37) % 11) - 5.0f;
+    x1[2] = x1[1];
+    x1[1] = x1[0];
+    x1[0] = x;
+    y1[2] = y1[1];
+    y1[1] = y1[0];
+    const SBiquad &s0 = sections[0];
+    y1[0] = s0.b0 * x1[0] + s0.b1 * x1[1] + s0.b2 * x1[2] - s0.a1 * y1[1] - s0.a2 * y1[2];
+    y2[2] = y2[1];
+    y2[1] = y2[0];
+    const SBiquad &s1 = sections[1];
+    y2[0] = s1.b0 * y1[0] + s1.b1 * y1[1] + s1.b2 * y1[2] - s1.a1 * y2[1] - s1.a2 * y2[2];
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, y2[0], iir.process(x));
+  }
+
+  // Скорость: выравнивание и свертка против свертки по двум участкам.
+  float acc = 0;
+  STARTTIMESHOT();
+  for (int i = 0; i < 16384; i++)
+  {
+    naive->push(in[i & 1023]);
+    float *x = naive->align();
+    for (int k = 0; k < 32; k++)
+      acc += x[k] * coeffs[k];
+  }
+  STOPTIMESHOT("FIR 32 taps x 16384: align");
+  TEST_ASSERT_TRUE(acc > 0);
+  STARTTIMESHOT();
+  for (int i = 0; i < 16; i++)
+    fir->process(in, out, 1024);
+  STOPTIMESHOT("FIR 32 taps x 16384: spans");
+  STARTTIMESHOT();
+  for (int i = 0; i < 16; i++)
+    fixed->process(in, outFixed, 1024);
+  STOPTIMESHOT("FIR 32 taps x 16384: constexpr");
+  STARTTIMESHOT();
+  for (int i = 0; i < 16; i++)
+    dec->process(in, outDec, 1024);
+  STOPTIMESHOT("FIR 32 taps x 16384: polyphase / 4");
+
+  delete[] outFixed;
+  delete[] outDec;
+  delete[] out;
+  delete[] in;
+  delete naive;
+  delete fixed;
+  delete dec;
+  delete fir;
+}
+
+/// Данные для тестирования TMultiFifoArray из нескольких задач.
+struct SMultiFifoTest
+{
+  TMultiFifoArray<int> *fifo;
+  int lossy;
+  volatile int errors;
+  volatile int received;
+  volatile bool producerDone;
+  volatile bool readerDone;
+};
+
+#define MULTIFIFO_TOTAL 100000
+
+static void multiFifoProducer(void *pvParameters)
+{
+  SMultiFifoTest *test = (SMultiFifoTest *)pvParameters;
+  int block[5];
+  int i = 0;
+  while (i < MULTIFIFO_TOTAL)
+  {
+    int n = std::min(5, MULTIFIFO_TOTAL - i);
+    for (int j = 0; j < n; j++)
+      block[j] = i + j;
+    int accepted = test->fifo->push(block, n);
+    i += accepted;
+    if (accepted == 0)
+      taskYIELD();
+  }
+  test->producerDone = true;
+  vTaskDelete(nullptr);
+}
+
+static void multiFifoLossyReader(void *pvParameters)
+{
+  SMultiFifoTest *test = (SMultiFifoTest *)pvParameters;
+  int block[4];
+  int last = -1;
+  int reads = 0;
+  while (last != (MULTIFIFO_TOTAL - 1))
+  {
+    int n = test->fifo->read(test->lossy, block, 4);
+    for (int j = 0; j < n; j++)
+    {
+      if (block[j] <= last)
+        test->errors++;
+      last = block[j];
+    }
+    test->received += n;
+    // Читатель периодически отстает, чтобы производитель перезаписывал непрочитанные и копируемые данные.
+    if ((++reads % 64) == 0)
+      vTaskDelay(1);
+    else if (n == 0)
+      taskYIELD();
+  }
+  test->readerDone = true;
+  vTaskDelete(nullptr);
+}
+
+/// Тест TMultiFifoArray.
+TEST_CASE("TMultiFifoArray", "[task]")
+{
+  TMultiFifoArray<int, 8> fifo;
+  int lossy = fifo.addCursor();
+  int blocking = fifo.addCursor(true);
+  TEST_ASSERT_EQUAL_INT(0, lossy);
+  TEST_ASSERT_EQUAL_INT(1, blocking);
+
+  int data[12];
+  for (int i = 0; i < 12; i++)
+    data[i] = i;
+  TEST_ASSERT_EQUAL_INT(6, fifo.push(data, 6));
+  TEST_ASSERT_EQUAL_INT(2, fifo.push(&data[6], 6));
+
+  int out[16];
+  TEST_ASSERT_EQUAL_INT(8, fifo.read(lossy, out, 16));
+  TEST_ASSERT_EQUAL_INT(7, out[7]);
+  TEST_ASSERT_EQUAL_INT(3, fifo.read(blocking, out, 3));
+  TEST_ASSERT_EQUAL_INT(2, out[2]);
+  TEST_ASSERT_EQUAL_INT(3, fifo.push(&data[8], 4));
+
+  fifo.removeCursor(blocking);
+  TEST_ASSERT_EQUAL_INT(12, fifo.push(data, 12));
+  TEST_ASSERT_EQUAL_INT(15, fifo.getAvailable(lossy));
+  TEST_ASSERT_EQUAL_INT(8, fifo.read(lossy, out, 16));
+  TEST_ASSERT_EQUAL_INT(7, fifo.getOverruns(lossy));
+  TEST_ASSERT_EQUAL_INT(11, out[7]);
+
+  // Производитель и читатель без потерь на разных ядрах, читатель с потерями отстает.
+  SMultiFifoTest *test = new SMultiFifoTest();
+  test->fifo = new TMultiFifoArray<int>(61);
+  int reader = test->fifo->addCursor(true);
+  test->lossy = test->fifo->addCursor();
+  xTaskCreatePinnedToCore(multiFifoLossyReader, "lossy", 2048, test, 5, nullptr, 0);
+  xTaskCreatePinnedToCore(multiFifoProducer, "producer", 2048, test, 5, nullptr, 1);
+  int expected = 0;
+  while (expected < MULTIFIFO_TOTAL)
+  {
+    int n = test->fifo->read(reader, out, 16);
+    for (int j = 0; j < n; j++)
+    {
+      TEST_ASSERT_EQUAL_INT(expected, out[j]);
+      expected++;
+    }
+    if (n == 0)
+      taskYIELD();
+  }
+  for (int i = 0; (i < 100) && !(test->producerDone && test->readerDone); i++)
+    vTaskDelay(pdMS_TO_TICKS(10));
+  TEST_ASSERT_TRUE(test->producerDone);
+  TEST_ASSERT_TRUE(test->readerDone);
+  TEST_ASSERT_EQUAL_INT(0, test->errors);
+  TEST_ASSERT_EQUAL_INT(MULTIFIFO_TOTAL, test->received + test->fifo->getOverruns(test->lossy));
+  TEST_ASSERT_TRUE(test->fifo->getOverruns(test->lossy) > 0);
+  vTaskDelay(pdMS_TO_TICKS(10));
+  delete test->fifo;
+  delete test;
+}
+
+/// Тест TTimedFifo.
+TEST_CASE("TTimedFifo", "[task]")
+{
+  TTimedFifo<int> fifo(100, 8, 1000);
+  int block[10];
+  int value = 0;
+  for (int i = 0; i < 20; i++)
+  {
+    for (int j = 0; j < 10; j++)
+      block[j] = value++;
+    fifo.push(block, 10, 1000000 + i * 10000);
+  }
+  TEST_ASSERT_EQUAL_INT(1, fifo.getStampCount());
+
+  int index;
+  TFifoSpans<int> spans = fifo.query(1150000, 1159000, &index);
+  TEST_ASSERT_EQUAL_INT(10, spans.firstSize + spans.secondSize);
+  TEST_ASSERT_EQUAL_INT(150, spans.first[0]);
+  TEST_ASSERT_EQUAL_INT(1150000, fifo.getTime(index));
+
+  fifo.setTolerance(100);
+  for (int i = 0; i < 10; i++)
+  {
+    for (int j = 0; j < 10; j++)
+      block[j] = value++;
+    fifo.push(block, 10, 1200000 + i * 5000);
+  }
+  // Блок 200 совпал с прогнозом старой частоты и получил метку при смене частоты.
+  TEST_ASSERT_EQUAL_INT(3, fifo.getStampCount());
+  TEST_ASSERT_EQUAL_INT(1200000, fifo.getTime(-100));
+  TEST_ASSERT_EQUAL_INT(1202500, fifo.getTime(-95));
+  spans = fifo.query(1210000, 1214999);
+  TEST_ASSERT_EQUAL_INT(10, spans.firstSize + spans.secondSize);
+  TEST_ASSERT_EQUAL_INT(220, spans.first[0]);
+  TEST_ASSERT_EQUAL_INT(1249500, fifo.getTime(-1));
+  spans = fifo.query(0, 100);
+  TEST_ASSERT_EQUAL_INT(0, spans.firstSize + spans.secondSize);
+  spans = fifo.query(5000000, 6000000, &index);
+  TEST_ASSERT_EQUAL_INT(0, spans.firstSize + spans.secondSize);
+  TEST_ASSERT_EQUAL_INT(0, index);
+
+  // Блок с временем раньше последней метки не ломает порядок меток.
+  int stamps = fifo.getStampCount();
+  fifo.push(block, 10, 1000000);
+  TEST_ASSERT_EQUAL_INT(stamps, fifo.getStampCount());
+  TEST_ASSERT_EQUAL_INT(1254500, fifo.getTime(-1));
+}
+
+/// Тест TSpscFifoArray.
+TEST_CASE("TSpscFifoArray", "[task]")
+{
+  TSpscFifoArray<int, 8> fifo;
+  uint32_t bits = 0;
+  xTaskNotifyWait(0, 0xffffffff, &bits, 0);
+  fifo.setNotify(xTaskGetCurrentTaskHandle(), 3, 4);
+
+  int data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  fifo.push(data, 3);
+  TEST_ASSERT_EQUAL(pdFALSE, xTaskNotifyWait(0, (1 << 3), &bits, 0));
+  fifo.push(data, 2);
+  TEST_ASSERT_EQUAL(pdTRUE, xTaskNotifyWait(0, (1 << 3), &bits, 0));
+  TEST_ASSERT_EQUAL_INT(5, fifo.getCount());
+  fifo.push(data, 5);
+  TEST_ASSERT_EQUAL_INT(8, fifo.getCount());
+  TEST_ASSERT_EQUAL_INT(2, fifo.getLost());
+
+  int out[8];
+  TEST_ASSERT_EQUAL_INT(6, fifo.pop(out, 6));
+  TEST_ASSERT_EQUAL_INT(2, out[2]);
+  TEST_ASSERT_EQUAL_INT(0, out[3]);
+  fifo.push(data, 6);
+  TEST_ASSERT_EQUAL_INT(8, fifo.pop(out, 8));
+  TEST_ASSERT_EQUAL_INT(2, out[1]);
+  TEST_ASSERT_EQUAL_INT(5, out[7]);
+  int value;
+  TEST_ASSERT_FALSE(fifo.pop(value));
+}
+
+/// Тест TMirrorFifoArray.
+TEST_CASE("TMirrorFifoArray", "[task]")
+{
+  TMirrorFifoArray<int> fifo(8);
+  int size = fifo.getSize();
+  TEST_ASSERT_TRUE(size >= 8);
+  for (int i = 0; i < size + 3; i++)
+  {
+    fifo.push(i);
+  }
+  int data[5] = {100, 101, 102, 103, 104};
+  fifo.push(data, 5);
+  TEST_ASSERT_EQUAL_INT(104, fifo[-1]);
+  const int *w = fifo.window(size);
+  TEST_ASSERT_EQUAL_INT(8, w[0]);
+  for (int i = 0; i < 5; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(100 + i, w[size - 5 + i]);
+  }
+  for (int i = 0; i < size - 5; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(8 + i, w[i]);
+  }
+}